@@ -0,0 +1,252 @@
+/*
+ * aio_bench.cc
+ *	  Read-ahead throughput as the I/O queue depth grows.
+ *
+ * Writes a local file whose every page carries its own block number, then
+ * reads a column's worth of pages through ReadAhead at each queue depth,
+ * once per backend, dropping the file from the OS page cache before every
+ * run.  A plain synchronous pread loop over the same pages is the baseline.
+ * Every page delivered is checked, and every page must be delivered exactly
+ * once.
+ *
+ * The file is laid out the way the bulk loader writes it: 16-page extents,
+ * with --columns columns interleaved extent by extent.  The benchmark scans
+ * column 0, so with --columns=1 the scan is purely sequential, and with more
+ * columns it reads one extent out of every C.
+ *
+ * usage: zs_aio_bench [--pages=N] [--columns=C] [--depths=d1,d2,...]
+ *                     [--coalesce=P] [--backend=all|io_uring|thread_pool]
+ *                     [--direct] [--dir=PATH] [--keep]
+ */
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "aio/read_ahead.h"
+#include "storage/page_file.h"
+
+#include "bench_util.h"
+
+using namespace zs;
+
+namespace {
+
+constexpr BlockNumber kExtentPages = 16;
+
+struct Options {
+  BlockNumber pages = 32768;
+  int columns = 1;
+  std::vector<int> depths = {1, 2, 4, 8, 16, 32, 64};
+  unsigned coalesce = 1;
+  std::string backend = "all";
+  bool direct = false;
+  std::string dir = ".";
+  bool keep = false;
+};
+
+Options parse_options(int argc, char** argv) {
+  Options opts;
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (std::strncmp(arg, "--pages=", 8) == 0)
+      opts.pages = static_cast<BlockNumber>(std::strtoul(arg + 8, nullptr, 10));
+    else if (std::strncmp(arg, "--columns=", 10) == 0)
+      opts.columns = std::atoi(arg + 10);
+    else if (std::strncmp(arg, "--depths=", 9) == 0)
+      opts.depths = parse_list(arg + 9);
+    else if (std::strncmp(arg, "--coalesce=", 11) == 0)
+      opts.coalesce = static_cast<unsigned>(std::atoi(arg + 11));
+    else if (std::strncmp(arg, "--backend=", 10) == 0)
+      opts.backend = arg + 10;
+    else if (std::strcmp(arg, "--direct") == 0)
+      opts.direct = true;
+    else if (std::strncmp(arg, "--dir=", 6) == 0)
+      opts.dir = arg + 6;
+    else if (std::strcmp(arg, "--keep") == 0)
+      opts.keep = true;
+    else {
+      std::fprintf(stderr,
+                   "usage: %s [--pages=N] [--columns=C] [--depths=d1,d2,...] "
+                   "[--coalesce=P] [--backend=all|io_uring|thread_pool] "
+                   "[--direct] [--dir=PATH] [--keep]\n",
+                   argv[0]);
+      std::exit(2);
+    }
+  }
+  return opts;
+}
+
+void write_file(const std::string& path, BlockNumber npages) {
+  PageFile file = PageFile::create(path);
+  Page page;
+  std::memset(page.data, 0, kBlockSize);
+  for (BlockNumber blkno = 0; blkno < npages; blkno++) {
+    std::memcpy(page.data, &blkno, sizeof(blkno));
+    std::memcpy(page.data + kBlockSize - sizeof(blkno), &blkno, sizeof(blkno));
+    file.write(blkno, &page);
+  }
+  file.sync();
+}
+
+// Offsets of column 0's pages when columns are interleaved by extent.
+std::vector<uint64_t> column_offsets(BlockNumber npages, int columns) {
+  std::vector<uint64_t> offsets;
+  BlockNumber stride = kExtentPages * static_cast<BlockNumber>(columns);
+  for (BlockNumber start = 0; start < npages; start += stride)
+    for (BlockNumber b = start; b < start + kExtentPages && b < npages; b++)
+      offsets.push_back(static_cast<uint64_t>(b) * kBlockSize);
+  return offsets;
+}
+
+bool check_page(const unsigned char* data, uint64_t offset) {
+  BlockNumber head, tail;
+  std::memcpy(&head, data, sizeof(head));
+  std::memcpy(&tail, data + kBlockSize - sizeof(tail), sizeof(tail));
+  BlockNumber expect = static_cast<BlockNumber>(offset / kBlockSize);
+  return head == expect && tail == expect;
+}
+
+void drop_cache(const std::string& path) {
+  PageFile::open(path).drop_os_cache();
+}
+
+struct Result {
+  double seconds = 0;
+  uint64_t batches = 0;
+  uint64_t errors = 0;
+};
+
+Result run_read_ahead(const std::string& path,
+                      const std::vector<uint64_t>& offsets,
+                      const ReadAheadOptions& ra_opts) {
+  Result r;
+  std::vector<uint8_t> seen(offsets.size(), 0);
+  auto start = std::chrono::steady_clock::now();
+  ReadAhead ra(path, offsets, ra_opts);
+  ReadBatch batch;
+  while (ra.next(&batch)) {
+    for (uint32_t i = 0; i < batch.npages; i++) {
+      size_t index = batch.first + i;
+      if (!check_page(batch.data + i * kBlockSize, offsets[index]) ||
+          seen[index]++ != 0)
+        r.errors++;
+    }
+    r.batches++;
+    ra.release(batch);
+  }
+  r.seconds = seconds_since(start);
+  for (uint8_t s : seen)
+    if (s != 1)
+      r.errors++;
+  return r;
+}
+
+Result run_sync(const std::string& path, const std::vector<uint64_t>& offsets,
+                bool direct) {
+  Result r;
+  int fd = ::open(path.c_str(), O_RDONLY | (direct ? O_DIRECT : 0));
+  if (fd < 0) {
+    std::perror(path.c_str());
+    std::exit(1);
+  }
+  Page page;  // 64-byte aligned is not enough for O_DIRECT
+  void* buf = std::aligned_alloc(4096, kBlockSize);
+  auto start = std::chrono::steady_clock::now();
+  for (uint64_t offset : offsets) {
+    if (::pread(fd, buf, kBlockSize, static_cast<off_t>(offset)) !=
+        static_cast<ssize_t>(kBlockSize)) {
+      r.errors++;
+      continue;
+    }
+    std::memcpy(page.data, buf, kBlockSize);
+    if (!check_page(page.data, offset))
+      r.errors++;
+    r.batches++;
+  }
+  r.seconds = seconds_since(start);
+  std::free(buf);
+  ::close(fd);
+  return r;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opts = parse_options(argc, argv);
+  if (opts.columns <= 0 || opts.coalesce == 0) {
+    std::fprintf(stderr, "--columns and --coalesce must be positive\n");
+    return 2;
+  }
+
+  std::vector<AioBackend> backends;
+  bool uring = ReadAhead::uring_available();
+  if (opts.backend == "all" || opts.backend == "io_uring") {
+    if (uring)
+      backends.push_back(AioBackend::kIoUring);
+    else
+      std::printf("io_uring is not available on this system; skipping it\n");
+  }
+  if (opts.backend == "all" || opts.backend == "thread_pool")
+    backends.push_back(AioBackend::kThreadPool);
+
+  std::string path = opts.dir + "/aio_bench.data";
+  std::printf("writing %u pages (%.1f MB)\n", opts.pages,
+              opts.pages * double(kBlockSize) / 1e6);
+  write_file(path, opts.pages);
+
+  std::vector<uint64_t> offsets = column_offsets(opts.pages, opts.columns);
+  double bytes = offsets.size() * double(kBlockSize);
+  std::printf("scanning column 0 of %d: %zu pages (%.1f MB), up to %u pages "
+              "per read%s\n",
+              opts.columns, offsets.size(), bytes / 1e6, opts.coalesce,
+              opts.direct ? ", O_DIRECT" : "");
+
+  int status = 0;
+  auto report = [&](const char* backend, int depth, const Result& r) {
+    if (depth > 0)
+      std::printf("%-12s %6d %10.4f %10llu %8.3f\n", backend, depth, r.seconds,
+                  static_cast<unsigned long long>(r.batches),
+                  bytes / r.seconds / 1e9);
+    else
+      std::printf("%-12s %6s %10.4f %10llu %8.3f\n", backend, "-", r.seconds,
+                  static_cast<unsigned long long>(r.batches),
+                  bytes / r.seconds / 1e9);
+    if (r.errors != 0) {
+      std::fprintf(stderr, "%s: %llu pages missing or wrong\n", backend,
+                   static_cast<unsigned long long>(r.errors));
+      status = 1;
+    }
+  };
+
+  std::printf("%-12s %6s %10s %10s %8s\n", "backend", "depth", "seconds",
+              "reads", "GB/s");
+  drop_cache(path);
+  report("pread", 0, run_sync(path, offsets, opts.direct));
+
+  for (AioBackend backend : backends) {
+    const char* name =
+        backend == AioBackend::kIoUring ? "io_uring" : "thread_pool";
+    for (int depth : opts.depths) {
+      if (depth <= 0)
+        continue;
+      ReadAheadOptions ra_opts;
+      ra_opts.queue_depth = static_cast<unsigned>(depth);
+      ra_opts.max_pages_per_read = opts.coalesce;
+      ra_opts.backend = backend;
+      ra_opts.direct = opts.direct;
+      drop_cache(path);
+      report(name, depth, run_read_ahead(path, offsets, ra_opts));
+    }
+  }
+
+  if (!opts.keep)
+    ::unlink(path.c_str());
+  return status;
+}
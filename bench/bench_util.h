@@ -0,0 +1,51 @@
+/*
+ * bench_util.h
+ *	  Small helpers shared by the benchmark programs.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace zs {
+
+// Parses a comma-separated list of integers, as in --threads=1,2,4.
+inline std::vector<int> parse_list(const char* s) {
+  std::vector<int> out;
+  while (*s) {
+    out.push_back(std::atoi(s));
+    const char* comma = std::strchr(s, ',');
+    if (comma == nullptr)
+      break;
+    s = comma + 1;
+  }
+  return out;
+}
+
+// Well-mixed 64-bit values, for generating test data.
+inline uint64_t splitmix64(uint64_t& state) {
+  uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+// A cheaper generator for picking pages inside timed loops.  state must be
+// nonzero.
+inline uint64_t xorshift64(uint64_t& state) {
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+inline double seconds_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+}  // namespace zs
@@ -0,0 +1,147 @@
+/*
+ * codec_bench.cc
+ *	  Decode throughput of every codec at every ISA level the CPU supports.
+ *
+ * Each benchmark decodes a 64K-value chunk of synthetic data shaped to suit
+ * its codec, batch by batch, and reports values per second.  The decoded
+ * output is checked against the input once before timing starts, so a
+ * broken kernel fails loudly instead of producing a fast number.
+ *
+ * usage: zs_codec_bench [google benchmark flags]
+ */
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "codec/codec.h"
+
+#include "bench_util.h"
+
+using namespace zs;
+
+namespace {
+
+constexpr size_t kChunkValues = 64 * 1024;
+
+// Values clustered around a large offset: FOR removes the offset.
+std::vector<int64_t> make_for_data(unsigned bits) {
+  uint64_t rng = 1;
+  std::vector<int64_t> v(kChunkValues);
+  for (auto& x : v)
+    x = 1000000000000LL +
+        static_cast<int64_t>(splitmix64(rng) & ((1ULL << bits) - 1));
+  return v;
+}
+
+// Increasing timestamps with small jittered gaps.
+std::vector<int64_t> make_delta_data(unsigned bits) {
+  uint64_t rng = 2;
+  std::vector<int64_t> v(kChunkValues);
+  int64_t t = 1700000000000000LL;
+  for (auto& x : v) {
+    t += static_cast<int64_t>(splitmix64(rng) & ((1ULL << bits) - 1));
+    x = t;
+  }
+  return v;
+}
+
+// Small non-negative values.
+std::vector<int64_t> make_bitpack_data(unsigned bits) {
+  uint64_t rng = 3;
+  std::vector<int64_t> v(kChunkValues);
+  for (auto& x : v)
+    x = static_cast<int64_t>(splitmix64(rng) & ((1ULL << bits) - 1));
+  return v;
+}
+
+// Runs of average length 2^bits.
+std::vector<int64_t> make_rle_data(unsigned bits) {
+  uint64_t rng = 4;
+  std::vector<int64_t> v(kChunkValues);
+  int64_t value = 0;
+  for (auto& x : v) {
+    if ((splitmix64(rng) & ((1ULL << bits) - 1)) == 0)
+      value = static_cast<int64_t>(splitmix64(rng) >> 40);
+    x = value;
+  }
+  return v;
+}
+
+std::vector<int64_t> make_data(Codec codec, unsigned bits) {
+  switch (codec) {
+    case Codec::kFor:
+      return make_for_data(bits);
+    case Codec::kDelta:
+      return make_delta_data(bits);
+    case Codec::kBitPack:
+      return make_bitpack_data(bits);
+    case Codec::kRle:
+      return make_rle_data(bits);
+  }
+  return {};
+}
+
+void BM_Decode(benchmark::State& state, Codec codec, Isa isa, unsigned bits) {
+  std::vector<int64_t> input = make_data(codec, bits);
+  std::vector<unsigned char> encoded;
+  encode(codec, input.data(), input.size(), encoded);
+
+  std::vector<int64_t> out(kChunkValues + kDecodeBatchSize);
+  {
+    Decoder check(encoded.data(), encoded.size(), isa);
+    check.decode_all(out.data());
+    for (size_t i = 0; i < kChunkValues; i++)
+      if (out[i] != input[i]) {
+        state.SkipWithError("decoded values do not match input");
+        return;
+      }
+  }
+
+  std::vector<int64_t> batch(kDecodeBatchSize);
+  for (auto _ : state) {
+    Decoder dec(encoded.data(), encoded.size(), isa);
+    size_t n;
+    while ((n = dec.next_batch(batch.data())) > 0)
+      benchmark::DoNotOptimize(batch.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(kChunkValues));
+  state.counters["bytes/value"] =
+      static_cast<double>(encoded.size()) / kChunkValues;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const Codec codecs[] = {Codec::kFor, Codec::kDelta, Codec::kBitPack,
+                          Codec::kRle};
+  const Isa isas[] = {Isa::kScalar, Isa::kSse42, Isa::kAvx2};
+
+  for (Codec codec : codecs) {
+    // For RLE, bits is log2 of the average run length.
+    const unsigned widths[] = {1, 7, 13, 24, 40};
+    for (unsigned bits : widths) {
+      if (codec == Codec::kRle && bits > 13)
+        continue;
+      for (Isa isa : isas) {
+        if (!isa_supported(isa))
+          continue;
+        std::string name = std::string("decode/") + codec_name(codec) + "/" +
+                           isa_name(isa) + "/bits:" + std::to_string(bits);
+        benchmark::RegisterBenchmark(name.c_str(), BM_Decode, codec, isa, bits);
+      }
+    }
+  }
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
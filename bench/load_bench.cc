@@ -0,0 +1,214 @@
+/*
+ * load_bench.cc
+ *	  Bulk load throughput as the number of worker threads grows.
+ *
+ * Generates a table of binary rows in memory (an id column, a timestamp,
+ * low-cardinality codes, a slowly changing status and random payload) and
+ * loads it through load_binary() with each worker count, reporting rows
+ * per second and bytes written.  For reference it also loads the same rows
+ * through Relation::insert(), the one-descent-per-row path.  Each output
+ * file is scanned back and checksummed against the input.
+ *
+ * usage: zs_load_bench [--rows=N] [--workers=w1,w2,...] [--dir=PATH]
+ */
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "loader/bulk_loader.h"
+#include "loader/input.h"
+#include "storage/relation.h"
+#include "storage/table_scan.h"
+
+#include "bench_util.h"
+
+using namespace zs;
+
+namespace {
+
+struct Options {
+  uint64_t rows = 2000000;
+  std::vector<int> workers = {1, 2, 4, 8, 16};
+  std::string dir = ".";
+};
+
+Options parse_options(int argc, char** argv) {
+  Options opts;
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (std::strncmp(arg, "--rows=", 7) == 0)
+      opts.rows = std::strtoull(arg + 7, nullptr, 10);
+    else if (std::strncmp(arg, "--workers=", 10) == 0)
+      opts.workers = parse_list(arg + 10);
+    else if (std::strncmp(arg, "--dir=", 6) == 0)
+      opts.dir = arg + 6;
+    else {
+      std::fprintf(stderr,
+                   "usage: %s [--rows=N] [--workers=w1,w2,...] [--dir=PATH]\n",
+                   argv[0]);
+      std::exit(2);
+    }
+  }
+  return opts;
+}
+
+// id int64, ts int64, code int32, status int32, amount int64, payload int64 x3
+const std::vector<uint16_t> kAttlens = {8, 8, 4, 4, 8, 8, 8, 8};
+
+std::vector<unsigned char> make_rows(const Schema& schema, uint64_t nrows) {
+  std::vector<unsigned char> rows(nrows * schema.row_width());
+  uint64_t rng = 7;
+  int64_t ts = 1700000000000000LL;
+  int32_t status = 0;
+  for (uint64_t r = 0; r < nrows; r++) {
+    unsigned char* row = rows.data() + r * schema.row_width();
+    int64_t id = static_cast<int64_t>(r);
+    ts += static_cast<int64_t>(splitmix64(rng) % 1000);
+    int32_t code = static_cast<int32_t>(splitmix64(rng) % 200);
+    if (splitmix64(rng) % 500 == 0)
+      status = static_cast<int32_t>(splitmix64(rng) % 8);
+    int64_t amount = static_cast<int64_t>(splitmix64(rng) % 1000000);
+    std::memcpy(row + schema.offset(0), &id, 8);
+    std::memcpy(row + schema.offset(1), &ts, 8);
+    std::memcpy(row + schema.offset(2), &code, 4);
+    std::memcpy(row + schema.offset(3), &status, 4);
+    std::memcpy(row + schema.offset(4), &amount, 8);
+    for (int c = 5; c < schema.natts(); c++) {
+      int64_t v = static_cast<int64_t>(splitmix64(rng));
+      std::memcpy(row + schema.offset(c), &v, 8);
+    }
+  }
+  return rows;
+}
+
+// Sum of every value, read either from the row buffer or from a table.
+uint64_t checksum_rows(const Schema& schema,
+                       const std::vector<unsigned char>& rows) {
+  uint64_t sum = 0;
+  for (size_t off = 0; off < rows.size(); off += schema.row_width())
+    for (int c = 0; c < schema.natts(); c++) {
+      if (schema.attlen(c) == 8) {
+        int64_t v;
+        std::memcpy(&v, rows.data() + off + schema.offset(c), 8);
+        sum += static_cast<uint64_t>(v) * (c + 1);
+      } else {
+        int32_t v;
+        std::memcpy(&v, rows.data() + off + schema.offset(c), 4);
+        sum += static_cast<uint64_t>(static_cast<int64_t>(v)) * (c + 1);
+      }
+    }
+  return sum;
+}
+
+uint64_t checksum_table(const std::string& path, uint64_t* nrows) {
+  auto rel = Relation::open(path);
+  const Schema& schema = rel->schema();
+  std::vector<int> attnos;
+  for (int c = 0; c < schema.natts(); c++)
+    attnos.push_back(c);
+  TableScan scan(*rel, attnos, Snapshot{2});
+  ScanBatch batch;
+  uint64_t sum = 0;
+  *nrows = 0;
+  while (scan.next(batch)) {
+    for (int c = 0; c < schema.natts(); c++)
+      for (size_t i = 0; i < batch.nrows; i++) {
+        const unsigned char* p = batch.columns[c].data() + i * schema.attlen(c);
+        if (schema.attlen(c) == 8) {
+          int64_t v;
+          std::memcpy(&v, p, 8);
+          sum += static_cast<uint64_t>(v) * (c + 1);
+        } else {
+          int32_t v;
+          std::memcpy(&v, p, 4);
+          sum += static_cast<uint64_t>(static_cast<int64_t>(v)) * (c + 1);
+        }
+      }
+    *nrows += batch.nrows;
+  }
+  return sum;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opts = parse_options(argc, argv);
+  Schema schema(kAttlens);
+  std::string path = opts.dir + "/load_bench.zs";
+
+  std::printf("generating %llu rows x %d columns (%.1f MB)\n",
+              static_cast<unsigned long long>(opts.rows), schema.natts(),
+              opts.rows * schema.row_width() / 1e6);
+  std::vector<unsigned char> rows = make_rows(schema, opts.rows);
+  uint64_t expected = checksum_rows(schema, rows);
+
+  std::printf("%-12s %8s %14s %14s %10s %8s\n", "method", "workers", "rows/s",
+              "bytes_written", "ratio", "scaling");
+  int status = 0;
+
+  auto verify = [&](const char* method) {
+    uint64_t nrows;
+    if (checksum_table(path, &nrows) != expected || nrows != opts.rows) {
+      std::fprintf(stderr, "%s: loaded table does not match input\n", method);
+      status = 1;
+    }
+  };
+
+  {
+    auto start = std::chrono::steady_clock::now();
+    auto rel = Relation::create(path, schema);
+    for (uint64_t r = 0; r < opts.rows; r++)
+      rel->insert(rows.data() + r * schema.row_width(), 1);
+    rel->flush();
+    rel->store().file().sync();
+    double secs = seconds_since(start);
+    uint64_t bytes =
+        static_cast<uint64_t>(rel->store().file().nblocks()) * kBlockSize;
+    std::printf("%-12s %8d %14.0f %14llu %10.2f %8s\n", "insert", 1,
+                opts.rows / secs, static_cast<unsigned long long>(bytes),
+                static_cast<double>(rows.size()) / bytes, "-");
+    rel.reset();
+    verify("insert");
+  }
+
+  double base = 0;
+  for (int workers : opts.workers) {
+    if (workers < 1)
+      continue;
+    std::FILE* in = fmemopen(rows.data(), rows.size(), "rb");
+    if (in == nullptr) {
+      std::perror("fmemopen");
+      return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    LoadOptions load;
+    load.workers = workers;
+    LoadStats stats;
+    {
+      BulkLoader loader(path, schema, load);
+      load_binary(in, loader);
+      stats = loader.finish();
+    }
+    double secs = seconds_since(start);
+    std::fclose(in);
+
+    double rate = stats.rows / secs;
+    if (base == 0)
+      base = rate;
+    std::printf("%-12s %8d %14.0f %14llu %10.2f %7.2fx\n", "bulk_load",
+                workers, rate,
+                static_cast<unsigned long long>(stats.bytes_written),
+                static_cast<double>(rows.size()) / stats.bytes_written,
+                rate / base);
+    verify("bulk_load");
+  }
+
+  ::unlink(path.c_str());
+  return status;
+}
@@ -0,0 +1,170 @@
+/*
+ * scan_bench.cc
+ *	  Column-projected scan throughput: zedstore versus a row store.
+ *
+ * Builds a wide table of int64 columns in both layouts on local disk, then
+ * scans the first k columns of each for several k, dropping the files from
+ * the OS page cache before every scan.  For each k it reports elapsed time
+ * and the bytes actually read from the file.  The columnar scan's bytes
+ * grow with k; the row scan's do not.
+ *
+ * usage: zs_scan_bench [--rows=N] [--columns=C] [--project=k1,k2,...]
+ *                      [--dir=PATH] [--keep]
+ */
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "storage/relation.h"
+#include "storage/row_store.h"
+#include "storage/table_scan.h"
+
+#include "bench_util.h"
+
+using namespace zs;
+
+namespace {
+
+struct Options {
+  uint64_t rows = 500000;
+  int columns = 64;
+  std::vector<int> project = {1, 2, 4, 8, 16, 32, 64};
+  std::string dir = ".";
+  bool keep = false;
+};
+
+Options parse_options(int argc, char** argv) {
+  Options opts;
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (std::strncmp(arg, "--rows=", 7) == 0)
+      opts.rows = std::strtoull(arg + 7, nullptr, 10);
+    else if (std::strncmp(arg, "--columns=", 10) == 0)
+      opts.columns = std::atoi(arg + 10);
+    else if (std::strncmp(arg, "--project=", 10) == 0)
+      opts.project = parse_list(arg + 10);
+    else if (std::strncmp(arg, "--dir=", 6) == 0)
+      opts.dir = arg + 6;
+    else if (std::strcmp(arg, "--keep") == 0)
+      opts.keep = true;
+    else {
+      std::fprintf(stderr,
+                   "usage: %s [--rows=N] [--columns=C] [--project=k1,k2,...] "
+                   "[--dir=PATH] [--keep]\n",
+                   argv[0]);
+      std::exit(2);
+    }
+  }
+  return opts;
+}
+
+// Sums every projected int64 value so the two layouts can be cross-checked.
+template <typename Scan>
+uint64_t run_scan(Scan& scan, size_t ncols, uint64_t* nrows) {
+  ScanBatch batch;
+  uint64_t sum = 0;
+  *nrows = 0;
+  while (scan.next(batch)) {
+    for (size_t c = 0; c < ncols; c++) {
+      const int64_t* values =
+          reinterpret_cast<const int64_t*>(batch.columns[c].data());
+      for (size_t i = 0; i < batch.nrows; i++)
+        sum += static_cast<uint64_t>(values[i]);
+    }
+    *nrows += batch.nrows;
+  }
+  return sum;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opts = parse_options(argc, argv);
+  if (opts.columns <= 0 || static_cast<size_t>(opts.columns) > kMaxAttributes) {
+    std::fprintf(stderr, "--columns must be between 1 and %zu\n",
+                 kMaxAttributes);
+    return 2;
+  }
+
+  std::string zs_path = opts.dir + "/scan_bench.zs";
+  std::string row_path = opts.dir + "/scan_bench.rows";
+  Schema schema(std::vector<uint16_t>(opts.columns, sizeof(int64_t)));
+
+  std::printf("loading %llu rows x %d int64 columns\n",
+              static_cast<unsigned long long>(opts.rows), opts.columns);
+  {
+    auto rel = Relation::create(zs_path, schema);
+    auto rows = RowStore::create(row_path, schema);
+    std::vector<int64_t> row(opts.columns);
+    uint64_t rng = 42;
+    for (uint64_t r = 0; r < opts.rows; r++) {
+      for (int c = 0; c < opts.columns; c++)
+        row[c] = static_cast<int64_t>(splitmix64(rng) >> 16);
+      const unsigned char* bytes =
+          reinterpret_cast<const unsigned char*>(row.data());
+      rel->insert(bytes, 1);
+      rows->insert(bytes, 1);
+    }
+    rel->flush();
+    rows->flush();
+    rel->store().file().sync();
+    rows->file().sync();
+  }
+
+  auto rel = Relation::open(zs_path);
+  auto rows = RowStore::open(row_path);
+  Snapshot snapshot{2};
+
+  std::printf("%8s %12s %14s %10s %12s %14s %10s %9s\n", "columns",
+              "zs_seconds", "zs_bytes", "zs_MB/s", "row_seconds", "row_bytes",
+              "row_MB/s", "bytes_x");
+  for (int k : opts.project) {
+    if (k <= 0 || k > opts.columns)
+      continue;
+    std::vector<int> attnos;
+    for (int c = 0; c < k; c++)
+      attnos.push_back(c);
+
+    uint64_t zs_rows, row_rows;
+
+    rel->store().file().drop_os_cache();
+    rel->store().file().reset_stats();
+    auto start = std::chrono::steady_clock::now();
+    TableScan zscan(*rel, attnos, snapshot);
+    uint64_t zs_sum = run_scan(zscan, attnos.size(), &zs_rows);
+    double zs_secs = seconds_since(start);
+    uint64_t zs_bytes = rel->store().file().stats().bytes_read;
+
+    rows->file().drop_os_cache();
+    rows->file().reset_stats();
+    start = std::chrono::steady_clock::now();
+    RowScan rscan(*rows, attnos, snapshot);
+    uint64_t row_sum = run_scan(rscan, attnos.size(), &row_rows);
+    double row_secs = seconds_since(start);
+    uint64_t row_bytes = rows->file().stats().bytes_read;
+
+    if (zs_sum != row_sum || zs_rows != row_rows || zs_rows != opts.rows) {
+      std::fprintf(stderr, "result mismatch at %d columns\n", k);
+      return 1;
+    }
+
+    std::printf("%8d %12.4f %14llu %10.1f %12.4f %14llu %10.1f %9.2f\n", k,
+                zs_secs, static_cast<unsigned long long>(zs_bytes),
+                zs_bytes / zs_secs / 1e6, row_secs,
+                static_cast<unsigned long long>(row_bytes),
+                row_bytes / row_secs / 1e6,
+                static_cast<double>(row_bytes) / zs_bytes);
+  }
+
+  if (!opts.keep) {
+    ::unlink(zs_path.c_str());
+    ::unlink(row_path.c_str());
+  }
+  return 0;
+}
@@ -0,0 +1,277 @@
+/*
+ * stats_bench.cc
+ *	  Cost of the hot-path instrumentation on tight loops over the
+ *	  instrumented operations.
+ *
+ * Each workload repeatedly calls one instrumented operation:
+ *	 decode      Decoder::next_batch over a bit-packed chunk
+ *	 cache_hit   BufferCache::read of resident pages
+ *	 btree_find  BTree::find on a fully buffered tree
+ *	 page_read   PageFile::read of pages in the OS page cache
+ * and is timed with recording switched off and on at run time, back to
+ * back, for several rounds.  The overhead is the median over rounds of the
+ * on/off time ratio, reported against a budget of 2%; the per-operation
+ * times are each side's best round.  The snapshot collected
+ * while recording was on is printed at the end, through the C API.  The
+ * exit status is 1 if any workload is over budget.
+ *
+ * The baseline is recording switched off at run time, which still loads
+ * the enabled flag and constructs each StatTimer; it is not a
+ * -DZS_STATS=OFF build, so the budget does not bound the cost over a tree
+ * with the instrumentation compiled out.  The per-event sample intervals
+ * in stats.cc were chosen so that every workload here stays within it.
+ *
+ * usage: zs_stats_bench [--rounds=R] [--scale=S] [--json] [--dir=PATH]
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "cache/buffer_cache.h"
+#include "codec/codec.h"
+#include "stats/stats.h"
+#include "stats/zs_stats.h"
+#include "storage/btree.h"
+#include "storage/page_store.h"
+
+#include "bench_util.h"
+
+using namespace zs;
+
+namespace {
+
+constexpr double kBudgetPercent = 2.0;
+
+// Where the loops' checksums end up, so that they are not optimized away.
+volatile uint64_t g_sink;
+
+struct Options {
+  int rounds = 101;
+  double scale = 1.0;  // multiplies every workload's operation count
+  bool json = false;
+  std::string dir = ".";
+};
+
+Options parse_options(int argc, char** argv) {
+  Options opts;
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (std::strncmp(arg, "--rounds=", 9) == 0)
+      opts.rounds = std::atoi(arg + 9);
+    else if (std::strncmp(arg, "--scale=", 8) == 0)
+      opts.scale = std::atof(arg + 8);
+    else if (std::strcmp(arg, "--json") == 0)
+      opts.json = true;
+    else if (std::strncmp(arg, "--dir=", 6) == 0)
+      opts.dir = arg + 6;
+    else {
+      std::fprintf(stderr,
+                   "usage: %s [--rounds=R] [--scale=S] [--json] [--dir=PATH]\n",
+                   argv[0]);
+      std::exit(2);
+    }
+  }
+  return opts;
+}
+
+void write_file(const std::string& path, BlockNumber npages) {
+  PageFile file = PageFile::create(path);
+  Page page;
+  std::memset(page.data, 0, kBlockSize);
+  for (BlockNumber blkno = 0; blkno < npages; blkno++) {
+    std::memcpy(page.data, &blkno, sizeof(blkno));
+    file.write(blkno, &page);
+  }
+  file.sync();
+}
+
+struct Workload {
+  const char* name;
+  uint64_t ops;                       // operations per round
+  std::function<uint64_t()> round;    // returns a checksum
+};
+
+double time_round(const Workload& w, uint64_t* sink) {
+  auto start = std::chrono::steady_clock::now();
+  *sink += w.round();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opts = parse_options(argc, argv);
+  if (opts.rounds <= 0 || opts.scale <= 0) {
+    std::fprintf(stderr, "--rounds and --scale must be positive\n");
+    return 2;
+  }
+  auto scaled = [&](uint64_t n) {
+    return std::max<uint64_t>(1, static_cast<uint64_t>(n * opts.scale));
+  };
+
+  // decode: a 64K-value chunk of 12-bit values, decoded start to end.
+  const size_t kChunkValues = 65536;
+  std::vector<int64_t> values(kChunkValues);
+  uint64_t rng = 0x9E3779B97F4A7C15ULL;
+  for (int64_t& v : values)
+    v = static_cast<int64_t>(xorshift64(rng) & 0xFFF);
+  std::vector<unsigned char> chunk;
+  encode(Codec::kBitPack, values.data(), values.size(), chunk);
+  std::vector<int64_t> decoded(kDecodeBatchSize);
+  uint64_t decode_chunks = scaled(40);
+
+  // cache_hit and page_read: a small file that stays resident.
+  const BlockNumber kFilePages = 1024;
+  std::string cache_path = opts.dir + "/stats_bench.data";
+  write_file(cache_path, kFilePages);
+  BufferCache cache(kFilePages);
+  FileId file = cache.add_file(cache_path);
+  for (BlockNumber b = 0; b < kFilePages; b++)
+    cache.read(file, b);
+  PageFile page_file = PageFile::open(cache_path);
+  Page page;
+  uint64_t cache_reads = scaled(400000);
+  uint64_t page_reads = scaled(20000);
+
+  // btree_find: a three-level tree of 8-byte items, all pages buffered.
+  std::string tree_path = opts.dir + "/stats_bench.tree";
+  PageStore store(PageFile::create(tree_path));
+  BlockNumber root = kInvalidBlock;
+  BTree tree(store, &root, sizeof(uint64_t));
+  const uint64_t kTreeItems = 2000000;
+  for (zstid tid = kMinTid; tid < kMinTid + kTreeItems; tid++)
+    tree.append(tid, &tid);
+  uint64_t tree_finds = scaled(100000);
+
+  std::vector<Workload> workloads = {
+      {"decode", decode_chunks * (kChunkValues / kDecodeBatchSize),
+       [&] {
+         uint64_t sum = 0;
+         for (uint64_t i = 0; i < decode_chunks; i++) {
+           Decoder d(chunk.data(), chunk.size());
+           size_t n;
+           while ((n = d.next_batch(decoded.data())) > 0)
+             sum += static_cast<uint64_t>(decoded[n - 1]);
+         }
+         return sum;
+       }},
+      {"cache_hit", cache_reads,
+       [&] {
+         uint64_t sum = 0;
+         uint64_t state = 88172645463325252ULL;
+         for (uint64_t i = 0; i < cache_reads; i++) {
+           BlockNumber b = static_cast<BlockNumber>(xorshift64(state) %
+                                                    kFilePages);
+           PageRef ref = cache.read(file, b);
+           sum += ref.data()[0];
+         }
+         return sum;
+       }},
+      {"btree_find", tree_finds,
+       [&] {
+         uint64_t sum = 0;
+         uint64_t state = 88172645463325252ULL;
+         BlockNumber leaf;
+         for (uint64_t i = 0; i < tree_finds; i++) {
+           zstid tid = kMinTid + xorshift64(state) % kTreeItems;
+           const unsigned char* item = tree.find(tid, &leaf);
+           sum += item != nullptr ? item[0] : 0;
+         }
+         return sum;
+       }},
+      {"page_read", page_reads,
+       [&] {
+         uint64_t sum = 0;
+         for (uint64_t i = 0; i < page_reads; i++) {
+           page_file.read(static_cast<BlockNumber>(i % kFilePages), &page);
+           sum += page.data[0];
+         }
+         return sum;
+       }},
+  };
+
+  std::printf("%-11s %10s %12s %12s %10s %8s\n", "workload", "ops/round",
+              "off_ns/op", "on_ns/op", "overhead", "budget");
+  uint64_t sink = 0;
+  bool over = false;
+  for (const Workload& w : workloads) {
+    double off = 0, on = 0;
+    std::vector<double> ratios;
+    for (int r = 0; r < opts.rounds; r++) {
+      // Each round times both sides back to back, alternating which goes
+      // first, and contributes the ratio of the pair; the median ratio is
+      // immune to drift and to the odd disturbed round.
+      double t[2];
+      for (int side = 0; side < 2; side++) {
+        bool enable = (side == 0) == (r % 2 == 0);
+        stats_set_enabled(enable);
+        t[enable] = time_round(w, &sink);
+      }
+      ratios.push_back(t[1] / t[0]);
+      off = r == 0 ? t[0] : std::min(off, t[0]);
+      on = r == 0 ? t[1] : std::min(on, t[1]);
+    }
+    std::sort(ratios.begin(), ratios.end());
+    double overhead = (ratios[ratios.size() / 2] - 1.0) * 100.0;
+    bool ok = overhead < kBudgetPercent;
+    over |= !ok;
+    std::printf("%-11s %10llu %12.1f %12.1f %9.2f%% %8s\n", w.name,
+                static_cast<unsigned long long>(w.ops), off * 1e9 / w.ops,
+                on * 1e9 / w.ops, overhead, ok ? "ok" : "OVER");
+  }
+  stats_set_enabled(true);
+
+  zs_stats_snapshot* snap = zs_stats_snapshot_take();
+  if (snap == nullptr) {
+    std::fprintf(stderr, "could not take a stats snapshot\n");
+    return 1;
+  }
+  std::printf("\n");
+  for (int c = 0; c < zs_stats_counter_count(); c++)
+    std::printf("%-20s %14llu\n", zs_stats_counter_name(c),
+                static_cast<unsigned long long>(
+                    zs_stats_counter_value(snap, c)));
+  std::printf("\n%-17s %10s %10s %8s %8s %8s %10s\n", "histogram", "samples",
+              "mean_ns", "p50", "p99", "p99.9", "max");
+  for (int h = 0; h < zs_stats_histogram_count(); h++)
+    std::printf("%-17s %10llu %10.1f %8llu %8llu %8llu %10llu\n",
+                zs_stats_histogram_name(h),
+                static_cast<unsigned long long>(
+                    zs_stats_histogram_samples(snap, h)),
+                zs_stats_histogram_mean(snap, h),
+                static_cast<unsigned long long>(
+                    zs_stats_histogram_percentile(snap, h, 50)),
+                static_cast<unsigned long long>(
+                    zs_stats_histogram_percentile(snap, h, 99)),
+                static_cast<unsigned long long>(
+                    zs_stats_histogram_percentile(snap, h, 99.9)),
+                static_cast<unsigned long long>(
+                    zs_stats_histogram_max(snap, h)));
+  if (opts.json) {
+    size_t len = zs_stats_snapshot_json(snap, nullptr, 0);
+    std::string json(len + 1, '\0');
+    zs_stats_snapshot_json(snap, &json[0], json.size());
+    json.resize(len);
+    std::printf("\n%s\n", json.c_str());
+  }
+  zs_stats_snapshot_free(snap);
+
+  ::unlink(cache_path.c_str());
+  ::unlink(tree_path.c_str());
+  g_sink = sink;
+  if (over) {
+    std::printf("\noverhead above %.0f%% budget\n", kBudgetPercent);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * zonemap_bench.cc
+ *	  Page skipping and scan time of zone-map pruning at several
+ *	  selectivities.
+ *
+ * Writes a time-series segment (ts increasing, sensor id uniform in
+ * [0, 1000), a reading that is NULL 1% of the time) and runs
+ *
+ *	 SELECT sum(reading), count(*) WHERE ts BETWEEN lo AND hi
+ *
+ * for ranges covering a given fraction of the table, once with zone maps
+ * and once evaluating every row, dropping the OS cache before each scan.
+ * A final query filters on sensor = 42, which zone maps cannot help with
+ * because every page holds every sensor.
+ *
+ * usage: zs_zonemap_bench [--rows=N] [--rows-per-page=N] [--dir=PATH]
+ */
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "segment/segment_scan.h"
+#include "segment/segment_writer.h"
+
+#include "bench_util.h"
+
+using namespace zs;
+
+namespace {
+
+struct Options {
+  uint64_t rows = 8000000;
+  uint32_t rows_per_page = kDefaultRowsPerPage;
+  std::string dir = ".";
+};
+
+Options parse_options(int argc, char** argv) {
+  Options opts;
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (std::strncmp(arg, "--rows=", 7) == 0)
+      opts.rows = std::strtoull(arg + 7, nullptr, 10);
+    else if (std::strncmp(arg, "--rows-per-page=", 16) == 0)
+      opts.rows_per_page =
+          static_cast<uint32_t>(std::strtoul(arg + 16, nullptr, 10));
+    else if (std::strncmp(arg, "--dir=", 6) == 0)
+      opts.dir = arg + 6;
+    else {
+      std::fprintf(stderr,
+                   "usage: %s [--rows=N] [--rows-per-page=N] [--dir=PATH]\n",
+                   argv[0]);
+      std::exit(2);
+    }
+  }
+  return opts;
+}
+
+constexpr int kTs = 0;
+constexpr int kSensor = 1;
+constexpr int kReading = 2;
+constexpr int64_t kStartTs = 1700000000000LL;
+constexpr int64_t kTsStep = 10;
+
+struct Result {
+  double seconds;
+  uint64_t count;
+  int64_t sum;
+  SegmentScanStats stats;
+  uint64_t bytes_read;
+};
+
+Result run(SegmentReader& reader, const std::vector<Predicate>& preds,
+           bool zone_maps) {
+  reader.drop_os_cache();
+  reader.reset_stats();
+  auto start = std::chrono::steady_clock::now();
+
+  SegmentScan scan(reader, {kReading}, preds, zone_maps);
+  SegmentBatch batch;
+  Result r{};
+  while (scan.next(batch)) {
+    const std::vector<int64_t>& values = batch.columns[0];
+    const std::vector<uint8_t>& nulls = batch.nulls[0];
+    for (size_t i = 0; i < batch.nrows; i++)
+      if (!nulls[i])
+        r.sum += values[i];
+    r.count += batch.nrows;
+  }
+
+  r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                  .count();
+  r.stats = scan.stats();
+  r.bytes_read = reader.bytes_read();
+  return r;
+}
+
+void print(const char* query, const char* mode, const Result& r) {
+  std::printf("%-16s %-9s %10llu %10llu %10llu %12llu %10.4f\n", query, mode,
+              static_cast<unsigned long long>(r.count),
+              static_cast<unsigned long long>(r.stats.pages_skipped),
+              static_cast<unsigned long long>(r.stats.pages_total),
+              static_cast<unsigned long long>(r.bytes_read), r.seconds);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opts = parse_options(argc, argv);
+  std::string path = opts.dir + "/zonemap_bench.seg";
+
+  {
+    SegmentWriter writer(path, 3, opts.rows_per_page);
+    uint64_t rng = 11;
+    int64_t row[3];
+    uint8_t isnull[3] = {0, 0, 0};
+    for (uint64_t r = 0; r < opts.rows; r++) {
+      row[kTs] = kStartTs + static_cast<int64_t>(r) * kTsStep;
+      row[kSensor] = static_cast<int64_t>(splitmix64(rng) % 1000);
+      row[kReading] = static_cast<int64_t>(splitmix64(rng) % 100000);
+      isnull[kReading] = splitmix64(rng) % 100 == 0;
+      writer.append(row, isnull);
+    }
+    writer.finish();
+    std::printf("wrote %llu rows, %.1f MB\n",
+                static_cast<unsigned long long>(opts.rows),
+                writer.bytes_written() / 1e6);
+  }
+
+  SegmentReader reader(path);
+  std::printf("%-16s %-9s %10s %10s %10s %12s %10s\n", "query", "zonemaps",
+              "rows", "skipped", "pages", "bytes_read", "seconds");
+
+  int status = 0;
+  auto compare = [&](const char* name, const std::vector<Predicate>& preds) {
+    Result with = run(reader, preds, true);
+    Result without = run(reader, preds, false);
+    print(name, "on", with);
+    print(name, "off", without);
+    if (with.count != without.count || with.sum != without.sum) {
+      std::fprintf(stderr, "%s: results differ with and without zone maps\n",
+                   name);
+      status = 1;
+    }
+  };
+
+  const double selectivities[] = {0.001, 0.01, 0.1, 0.5, 1.0};
+  for (double sel : selectivities) {
+    // A window in the middle of the table.
+    uint64_t span = static_cast<uint64_t>(opts.rows * sel);
+    uint64_t first = (opts.rows - span) / 2;
+    int64_t lo = kStartTs + static_cast<int64_t>(first) * kTsStep;
+    int64_t hi = lo + static_cast<int64_t>(span) * kTsStep - 1;
+    char name[32];
+    std::snprintf(name, sizeof(name), "ts %.1f%%", sel * 100);
+    compare(name, {Predicate{kTs, CompareOp::kBetween, lo, hi}});
+  }
+  compare("sensor = 42", {Predicate{kSensor, CompareOp::kEq, 42}});
+
+  ::unlink(path.c_str());
+  return status;
+}
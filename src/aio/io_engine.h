@@ -0,0 +1,47 @@
+/*
+ * io_engine.h
+ *	  Asynchronous positional reads, behind one interface for io_uring and
+ *	  for a pread thread pool.
+ *
+ * Callers queue reads with prepare(), hand them over with submit(), and
+ * collect completions with wait().  Every read carries a caller-chosen tag
+ * that comes back with its completion.  An engine is driven from a single
+ * thread.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace zs {
+
+struct IoCompletion {
+  uint32_t tag;
+  int64_t result;  // bytes read, or -errno
+};
+
+class IoEngine {
+ public:
+  virtual ~IoEngine() = default;
+
+  virtual void prepare(uint32_t tag, int fd, void* buf, size_t len,
+                       uint64_t offset) = 0;
+  virtual void submit() = 0;
+
+  // Blocks until at least one read has completed, then appends every
+  // completion that is available to out.
+  virtual void wait(std::vector<IoCompletion>& out) = 0;
+
+  virtual const char* name() const = 0;
+};
+
+// Returns nullptr if the kernel does not provide io_uring (or forbids it).
+// depth bounds the number of reads in flight; tags must be below it.
+std::unique_ptr<IoEngine> make_uring_engine(unsigned depth);
+
+// nthreads workers each issuing blocking pread(2) calls.
+std::unique_ptr<IoEngine> make_thread_pool_engine(unsigned nthreads);
+
+}  // namespace zs
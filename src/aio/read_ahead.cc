@@ -0,0 +1,203 @@
+/*
+ * read_ahead.cc
+ *	  Queue-depth driven read-ahead over an IoEngine.
+ */
+#include "aio/read_ahead.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <exception>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+
+#include "storage/errors.h"
+
+namespace zs {
+
+namespace {
+
+// O_DIRECT wants buffers aligned to the logical block size; a page is
+// always enough.
+constexpr size_t kBufferAlign = 4096;
+
+}  // namespace
+
+bool ReadAhead::uring_available() {
+  return make_uring_engine(1) != nullptr;
+}
+
+ReadAhead::ReadAhead(const std::string& path,
+                     std::vector<uint64_t> page_offsets,
+                     const ReadAheadOptions& opts)
+    : page_size_(opts.page_size), offsets_(std::move(page_offsets)) {
+  if (opts.queue_depth == 0 || opts.max_pages_per_read == 0)
+    throw std::invalid_argument("queue depth and pages per read must be > 0");
+
+  switch (opts.backend) {
+    case AioBackend::kAuto:
+      engine_ = make_uring_engine(opts.queue_depth);
+      break;
+    case AioBackend::kIoUring:
+      engine_ = make_uring_engine(opts.queue_depth);
+      if (engine_ == nullptr)
+        throw std::runtime_error("io_uring is not available");
+      break;
+    case AioBackend::kThreadPool:
+      break;
+  }
+  if (engine_ == nullptr)
+    engine_ = make_thread_pool_engine(
+        opts.pool_threads != 0 ? opts.pool_threads : opts.queue_depth);
+
+  int flags = O_RDONLY | O_CLOEXEC | (opts.direct ? O_DIRECT : 0);
+  fd_ = ::open(path.c_str(), flags);
+  if (fd_ < 0)
+    throw_errno("open " + path);
+
+  // The destructor will not run if we throw, so undo the open and any
+  // slot buffers already allocated here.
+  try {
+    build_runs(opts.max_pages_per_read);
+
+    // No point allocating more slots than there are reads.
+    size_t nslots = std::min<size_t>(opts.queue_depth, runs_.size());
+    size_t slot_bytes = page_size_ * opts.max_pages_per_read;
+    slot_bytes = (slot_bytes + kBufferAlign - 1) / kBufferAlign * kBufferAlign;
+    slots_.resize(nslots);
+    for (size_t i = 0; i < nslots; i++) {
+      slots_[i].buf = static_cast<unsigned char*>(
+          std::aligned_alloc(kBufferAlign, slot_bytes));
+      if (slots_[i].buf == nullptr)
+        throw std::bad_alloc();
+    }
+    for (size_t i = nslots; i-- > 0;)
+      free_slots_.push_back(static_cast<uint32_t>(i));
+  } catch (...) {
+    for (Slot& s : slots_)
+      std::free(s.buf);
+    ::close(fd_);
+    throw;
+  }
+}
+
+ReadAhead::~ReadAhead() {
+  // Reads still in flight target our buffers; let them land first.
+  try {
+    while (in_flight_ > 0) {
+      completions_.clear();
+      engine_->wait(completions_);
+      in_flight_ -= static_cast<unsigned>(completions_.size());
+    }
+  } catch (...) {
+  }
+  engine_.reset();
+  for (Slot& s : slots_)
+    std::free(s.buf);
+  if (fd_ >= 0)
+    ::close(fd_);
+}
+
+void ReadAhead::build_runs(unsigned max_pages) {
+  size_t i = 0;
+  while (i < offsets_.size()) {
+    Run run{i, 1};
+    while (run.npages < max_pages && i + run.npages < offsets_.size() &&
+           offsets_[i + run.npages] ==
+               offsets_[i + run.npages - 1] + page_size_)
+      run.npages++;
+    runs_.push_back(run);
+    i += run.npages;
+  }
+}
+
+void ReadAhead::issue(uint32_t slot) {
+  Slot& s = slots_[slot];
+  const Run& run = runs_[s.run];
+  size_t len = static_cast<size_t>(run.npages) * page_size_;
+  engine_->prepare(slot, fd_, s.buf + s.done, len - s.done,
+                   offsets_[run.first] + s.done);
+  in_flight_++;
+}
+
+void ReadAhead::fill_queue() {
+  bool issued = false;
+  while (next_run_ < runs_.size() && !free_slots_.empty()) {
+    uint32_t slot = free_slots_.back();
+    free_slots_.pop_back();
+    slots_[slot].run = next_run_++;
+    slots_[slot].done = 0;
+    issue(slot);
+    issued = true;
+  }
+  if (issued)
+    engine_->submit();
+}
+
+bool ReadAhead::next(ReadBatch* batch) {
+  fill_queue();
+  while (ready_.empty()) {
+    if (in_flight_ == 0) {
+      if (next_run_ == runs_.size())
+        return false;
+      throw std::logic_error("read-ahead consumer holds every buffer slot");
+    }
+
+    completions_.clear();
+    engine_->wait(completions_);
+    // Account for every completion before reporting a failure, so that
+    // in_flight_ stays exact and the destructor's drain terminates.
+    std::exception_ptr error;
+    bool resubmit = false;
+    for (const IoCompletion& c : completions_) {
+      in_flight_--;
+      Slot& s = slots_[c.tag];
+      const Run& run = runs_[s.run];
+      if (c.result <= 0) {
+        // The run is abandoned, so its slot can go straight back.
+        free_slots_.push_back(c.tag);
+        if (error)
+          continue;
+        if (c.result < 0)
+          error = std::make_exception_ptr(
+              std::system_error(static_cast<int>(-c.result),
+                                std::generic_category(), "read-ahead read"));
+        else
+          error = std::make_exception_ptr(
+              std::runtime_error("read-ahead read past end of file"));
+        continue;
+      }
+      s.done += static_cast<size_t>(c.result);
+      if (s.done < static_cast<size_t>(run.npages) * page_size_) {
+        // Short read; ask for the rest.
+        issue(c.tag);
+        resubmit = true;
+      } else {
+        ready_.push_back(c.tag);
+      }
+    }
+    if (resubmit)
+      engine_->submit();
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+  uint32_t slot = ready_.front();
+  ready_.pop_front();
+  const Run& run = runs_[slots_[slot].run];
+  batch->first = run.first;
+  batch->npages = run.npages;
+  batch->data = slots_[slot].buf;
+  batch->slot = slot;
+  return true;
+}
+
+void ReadAhead::release(const ReadBatch& batch) {
+  free_slots_.push_back(batch.slot);
+}
+
+}  // namespace zs
@@ -0,0 +1,112 @@
+/*
+ * read_ahead.h
+ *	  Asynchronous read-ahead for sequential column scans.
+ *
+ * A column scan knows up front which pages it is going to touch: the leaf
+ * chain of a column tree, or the page list of a segment.  ReadAhead takes
+ * that list of page offsets, merges runs of adjacent pages into larger
+ * reads, and keeps up to queue_depth reads in flight at once, refilling the
+ * queue as reads complete.  Batches are handed to the consumer in the order
+ * they complete, not in page order; each carries the index of its first
+ * page in the original list.
+ *
+ * Reads go through io_uring when the kernel offers it, and otherwise
+ * through a small pool of threads issuing pread(2).  Each in-flight read
+ * owns one buffer slot, and a slot is reused only after the consumer has
+ * released the batch that was read into it, so a batch's data stays valid
+ * until release().
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "aio/io_engine.h"
+#include "storage/page.h"
+
+namespace zs {
+
+enum class AioBackend {
+  kAuto,        // io_uring if available, else the thread pool
+  kIoUring,
+  kThreadPool,
+};
+
+struct ReadAheadOptions {
+  unsigned queue_depth = 32;        // reads in flight, and buffer slots
+  unsigned max_pages_per_read = 16; // adjacent pages merged into one read
+  size_t page_size = kBlockSize;
+  AioBackend backend = AioBackend::kAuto;
+  unsigned pool_threads = 0;        // thread pool size; 0 means queue_depth
+  bool direct = false;              // open the file with O_DIRECT
+};
+
+struct ReadBatch {
+  size_t first;               // index into the page offset list
+  uint32_t npages;
+  const unsigned char* data;  // npages * page_size bytes
+  uint32_t slot;
+};
+
+class ReadAhead {
+ public:
+  // Opens path read-only.  Throws std::system_error, or std::runtime_error
+  // if kIoUring was asked for and io_uring is unavailable.
+  ReadAhead(const std::string& path, std::vector<uint64_t> page_offsets,
+            const ReadAheadOptions& opts = ReadAheadOptions());
+  ~ReadAhead();
+
+  ReadAhead(const ReadAhead&) = delete;
+  ReadAhead& operator=(const ReadAhead&) = delete;
+
+  // Blocks until a read has completed and returns it.  Returns false once
+  // every page has been delivered.  Throws std::system_error on a failed
+  // read, std::runtime_error on a read past the end of the file, and
+  // std::logic_error if the consumer holds every slot.  After a throw the
+  // reader can still be destroyed, but not read from.
+  bool next(ReadBatch* batch);
+
+  // Gives the batch's slot back for further reads.
+  void release(const ReadBatch& batch);
+
+  // Name of the backend in use, "io_uring" or "thread_pool".
+  const char* backend() const { return engine_->name(); }
+
+  // Whether io_uring can be set up on this system.
+  static bool uring_available();
+
+ private:
+  struct Run {
+    size_t first;
+    uint32_t npages;
+  };
+
+  struct Slot {
+    unsigned char* buf = nullptr;
+    size_t run = 0;   // index into runs_
+    size_t done = 0;  // bytes read so far
+  };
+
+  void build_runs(unsigned max_pages);
+  void issue(uint32_t slot);
+  void fill_queue();
+
+  int fd_ = -1;
+  size_t page_size_;
+  std::vector<uint64_t> offsets_;
+  std::vector<Run> runs_;
+  size_t next_run_ = 0;
+
+  std::unique_ptr<IoEngine> engine_;
+  std::vector<Slot> slots_;
+  std::vector<uint32_t> free_slots_;
+  unsigned in_flight_ = 0;
+  std::vector<IoCompletion> completions_;
+  std::deque<uint32_t> ready_;
+};
+
+}  // namespace zs
@@ -0,0 +1,137 @@
+/*
+ * thread_pool_engine.cc
+ *	  IoEngine on a pool of threads issuing blocking pread(2) calls, for
+ *	  systems without io_uring.
+ */
+#include <unistd.h>
+
+#include <cerrno>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "aio/io_engine.h"
+
+namespace zs {
+
+namespace {
+
+class ThreadPoolEngine : public IoEngine {
+ public:
+  explicit ThreadPoolEngine(unsigned nthreads) {
+    for (unsigned i = 0; i < nthreads; i++)
+      threads_.emplace_back([this] { worker_main(); });
+  }
+
+  ~ThreadPoolEngine() override {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      shutdown_ = true;
+    }
+    request_cv_.notify_all();
+    for (auto& t : threads_)
+      t.join();
+  }
+
+  void prepare(uint32_t tag, int fd, void* buf, size_t len,
+               uint64_t offset) override {
+    prepared_.push_back(Request{tag, fd, buf, len, offset});
+  }
+
+  void submit() override {
+    if (prepared_.empty())
+      return;
+    size_t n = prepared_.size();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (const Request& r : prepared_)
+        requests_.push_back(r);
+    }
+    prepared_.clear();
+    // Wake one worker per request rather than all of them; in steady state
+    // the scan refills one slot at a time.
+    if (n >= threads_.size())
+      request_cv_.notify_all();
+    else
+      while (n-- > 0)
+        request_cv_.notify_one();
+  }
+
+  void wait(std::vector<IoCompletion>& out) override {
+    std::unique_lock<std::mutex> lock(mutex_);
+    completion_cv_.wait(lock, [&] { return !completions_.empty(); });
+    out.insert(out.end(), completions_.begin(), completions_.end());
+    completions_.clear();
+  }
+
+  const char* name() const override { return "thread_pool"; }
+
+ private:
+  struct Request {
+    uint32_t tag;
+    int fd;
+    void* buf;
+    size_t len;
+    uint64_t offset;
+  };
+
+  static int64_t read_fully(const Request& r) {
+    char* p = static_cast<char*>(r.buf);
+    size_t done = 0;
+    while (done < r.len) {
+      ssize_t n = ::pread(r.fd, p + done, r.len - done,
+                          static_cast<off_t>(r.offset + done));
+      if (n < 0) {
+        if (errno == EINTR)
+          continue;
+        return -errno;
+      }
+      if (n == 0)
+        break;
+      done += static_cast<size_t>(n);
+    }
+    return static_cast<int64_t>(done);
+  }
+
+  void worker_main() {
+    for (;;) {
+      Request r;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        request_cv_.wait(lock, [&] { return shutdown_ || !requests_.empty(); });
+        if (shutdown_)
+          return;
+        r = requests_.front();
+        requests_.pop_front();
+      }
+      int64_t result = read_fully(r);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        completions_.push_back(IoCompletion{r.tag, result});
+      }
+      completion_cv_.notify_one();
+    }
+  }
+
+  std::vector<std::thread> threads_;
+  std::vector<Request> prepared_;  // owned by the submitting thread
+
+  std::mutex mutex_;
+  std::condition_variable request_cv_;
+  std::condition_variable completion_cv_;
+  std::deque<Request> requests_;
+  std::vector<IoCompletion> completions_;
+  bool shutdown_ = false;
+};
+
+}  // namespace
+
+std::unique_ptr<IoEngine> make_thread_pool_engine(unsigned nthreads) {
+  if (nthreads == 0)
+    throw std::invalid_argument("thread pool engine needs at least one thread");
+  return std::make_unique<ThreadPoolEngine>(nthreads);
+}
+
+}  // namespace zs
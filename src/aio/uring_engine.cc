@@ -0,0 +1,185 @@
+/*
+ * uring_engine.cc
+ *	  IoEngine on io_uring, using the raw system call interface so that the
+ *	  module has no dependency beyond the kernel headers.
+ */
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "aio/io_engine.h"
+#include "storage/errors.h"
+
+namespace zs {
+
+namespace {
+
+int sys_io_uring_setup(unsigned entries, io_uring_params* p) {
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p));
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                       unsigned flags) {
+  return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit,
+                                    min_complete, flags, nullptr, 0));
+}
+
+template <typename T>
+T* ring_field(void* base, uint32_t offset) {
+  return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+class UringEngine : public IoEngine {
+ public:
+  UringEngine(int fd, const io_uring_params& p, unsigned depth)
+      : fd_(fd), params_(p), iovecs_(depth) {}
+
+  ~UringEngine() override {
+    if (sqes_ != nullptr)
+      ::munmap(sqes_, params_.sq_entries * sizeof(io_uring_sqe));
+    if (cq_ptr_ != nullptr && cq_ptr_ != sq_ptr_)
+      ::munmap(cq_ptr_, cq_size_);
+    if (sq_ptr_ != nullptr)
+      ::munmap(sq_ptr_, sq_size_);
+    ::close(fd_);
+  }
+
+  // Maps the rings.  Returns false if any mapping fails.
+  bool map_rings() {
+    sq_size_ = params_.sq_off.array + params_.sq_entries * sizeof(unsigned);
+    cq_size_ = params_.cq_off.cqes + params_.cq_entries * sizeof(io_uring_cqe);
+    bool single = params_.features & IORING_FEAT_SINGLE_MMAP;
+    if (single)
+      sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+
+    sq_ptr_ = ::mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+    if (sq_ptr_ == MAP_FAILED) {
+      sq_ptr_ = nullptr;
+      return false;
+    }
+    if (single) {
+      cq_ptr_ = sq_ptr_;
+    } else {
+      cq_ptr_ = ::mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+      if (cq_ptr_ == MAP_FAILED) {
+        cq_ptr_ = nullptr;
+        return false;
+      }
+    }
+    void* sqes = ::mmap(nullptr, params_.sq_entries * sizeof(io_uring_sqe),
+                        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                        IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+      return false;
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    sq_tail_ = ring_field<unsigned>(sq_ptr_, params_.sq_off.tail);
+    sq_mask_ = *ring_field<unsigned>(sq_ptr_, params_.sq_off.ring_mask);
+    sq_array_ = ring_field<unsigned>(sq_ptr_, params_.sq_off.array);
+    cq_head_ = ring_field<unsigned>(cq_ptr_, params_.cq_off.head);
+    cq_tail_ = ring_field<unsigned>(cq_ptr_, params_.cq_off.tail);
+    cq_mask_ = *ring_field<unsigned>(cq_ptr_, params_.cq_off.ring_mask);
+    cqes_ = ring_field<io_uring_cqe>(cq_ptr_, params_.cq_off.cqes);
+    local_tail_ = *sq_tail_;
+    return true;
+  }
+
+  void prepare(uint32_t tag, int fd, void* buf, size_t len,
+               uint64_t offset) override {
+    // READV rather than READ so that kernels older than 5.6 work too.
+    iovecs_[tag] = iovec{buf, len};
+    unsigned index = local_tail_ & sq_mask_;
+    io_uring_sqe* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&iovecs_[tag]);
+    sqe->len = 1;
+    sqe->off = offset;
+    sqe->user_data = tag;
+    sq_array_[index] = index;
+    local_tail_++;
+    unsubmitted_++;
+  }
+
+  void submit() override {
+    if (unsubmitted_ == 0)
+      return;
+    __atomic_store_n(sq_tail_, local_tail_, __ATOMIC_RELEASE);
+    while (unsubmitted_ > 0) {
+      int n = sys_io_uring_enter(fd_, unsubmitted_, 0, 0);
+      if (n < 0) {
+        if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+          continue;
+        throw_errno("io_uring_enter failed");
+      }
+      unsubmitted_ -= static_cast<unsigned>(n);
+    }
+  }
+
+  void wait(std::vector<IoCompletion>& out) override {
+    for (;;) {
+      unsigned head = *cq_head_;
+      unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      if (head != tail) {
+        for (; head != tail; head++) {
+          const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+          out.push_back(IoCompletion{static_cast<uint32_t>(cqe.user_data),
+                                     cqe.res});
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        return;
+      }
+      if (sys_io_uring_enter(fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 &&
+          errno != EINTR)
+        throw_errno("io_uring_enter failed");
+    }
+  }
+
+  const char* name() const override { return "io_uring"; }
+
+ private:
+  int fd_;
+  io_uring_params params_;
+  std::vector<iovec> iovecs_;
+
+  void* sq_ptr_ = nullptr;
+  void* cq_ptr_ = nullptr;
+  size_t sq_size_ = 0;
+  size_t cq_size_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+  unsigned local_tail_ = 0;
+  unsigned unsubmitted_ = 0;
+};
+
+}  // namespace
+
+std::unique_ptr<IoEngine> make_uring_engine(unsigned depth) {
+  io_uring_params p;
+  std::memset(&p, 0, sizeof(p));
+  int fd = sys_io_uring_setup(depth, &p);
+  if (fd < 0)
+    return nullptr;
+
+  auto engine = std::make_unique<UringEngine>(fd, p, depth);
+  if (!engine->map_rings())
+    return nullptr;
+  return engine;
+}
+
+}  // namespace zs
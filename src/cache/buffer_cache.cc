@@ -0,0 +1,487 @@
+/*
+ * buffer_cache.cc
+ *	  Shared cache of fixed-size pages for concurrent column scans.
+ *
+ * Buffer state lives in one 64-bit word per buffer so that pinning,
+ * unpinning and the clock hand's decisions are all single CAS operations:
+ *
+ *	 bits  0-31  reference count (pins)
+ *	 bits 32-35  usage count, capped at kMaxUsage
+ *	 bit  40     LOCKED: claimed by the clock sweep, cannot be pinned
+ *	 bit  41     VALID: page contents are loaded
+ *	 bit  42     IO_IN_PROGRESS: the pinning thread is reading the page
+ *
+ * The mapping table is an array of cache-line sized buckets, each holding a
+ * spin bit and kBucketSlots buffer numbers (plus one, so zero means empty).
+ * A tag hashes to a home bucket; if that is full the entry goes to one of
+ * the next kMaxProbe - 1 buckets.  Readers scan the whole probe range
+ * without locking, since a slot in the home bucket can free up after an
+ * entry has overflowed past it.  A reader can still miss an entry that is
+ * moving under it; the insert path re-checks the probe range under the home
+ * bucket's spin bit and takes the entry it finds there, so such a false miss
+ * never creates a duplicate.
+ */
+#include "cache/buffer_cache.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include "stats/stats.h"
+#include "storage/errors.h"
+
+namespace zs {
+
+namespace {
+
+constexpr uint64_t kRefMask = 0xFFFFFFFFULL;
+constexpr int kUsageShift = 32;
+constexpr uint64_t kUsageOne = 1ULL << kUsageShift;
+constexpr uint64_t kUsageMask = 0xFULL << kUsageShift;
+constexpr uint64_t kMaxUsage = 5;
+constexpr uint64_t kLocked = 1ULL << 40;
+constexpr uint64_t kValid = 1ULL << 41;
+constexpr uint64_t kIoInProgress = 1ULL << 42;
+
+constexpr uint64_t kNoTag = ~0ULL;
+
+constexpr size_t kBucketSlots = 15;
+constexpr uint32_t kMaxProbe = 4;
+
+inline uint64_t make_tag(FileId file, BlockNumber blkno) {
+  return (static_cast<uint64_t>(file) << 32) | blkno;
+}
+
+inline uint64_t usage(uint64_t state) {
+  return (state & kUsageMask) >> kUsageShift;
+}
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#endif
+}
+
+}  // namespace
+
+struct BufferCache::File {
+  int fd = -1;
+  const unsigned char* map = nullptr;
+  size_t size = 0;
+  std::string path;
+};
+
+struct BufferCache::Descriptor {
+  std::atomic<uint64_t> tag{kNoTag};
+  std::atomic<uint64_t> state{0};
+};
+
+struct alignas(64) BufferCache::Bucket {
+  std::atomic<uint32_t> lock{0};
+  std::atomic<uint32_t> slots[kBucketSlots];
+};
+static_assert(sizeof(std::atomic<uint32_t>) * (kBucketSlots + 1) == 64,
+              "a bucket should fill exactly one cache line");
+
+PageRef::PageRef(PageRef&& other) noexcept
+    : cache_(other.cache_), buffer_(other.buffer_), data_(other.data_) {
+  other.cache_ = nullptr;
+  other.data_ = nullptr;
+}
+
+PageRef& PageRef::operator=(PageRef&& other) noexcept {
+  if (this != &other) {
+    release();
+    cache_ = other.cache_;
+    buffer_ = other.buffer_;
+    data_ = other.data_;
+    other.cache_ = nullptr;
+    other.data_ = nullptr;
+  }
+  return *this;
+}
+
+void PageRef::release() {
+  if (cache_ != nullptr) {
+    cache_->unpin(buffer_);
+    cache_ = nullptr;
+    data_ = nullptr;
+  }
+}
+
+BufferCache::BufferCache(size_t nbuffers, ReadMode mode)
+    : nbuffers_(nbuffers), mode_(mode) {
+  if (nbuffers == 0 || nbuffers >= kRefMask)
+    throw std::invalid_argument("invalid number of buffers: " +
+                                std::to_string(nbuffers));
+
+  descriptors_.reset(new Descriptor[nbuffers]);
+  frames_ = static_cast<unsigned char*>(
+      std::aligned_alloc(4096, nbuffers * kBlockSize));
+  if (frames_ == nullptr)
+    throw std::bad_alloc();
+
+  // Aim for buckets about a quarter full on average.
+  size_t nbuckets = 1;
+  while (nbuckets * kBucketSlots < nbuffers * 4)
+    nbuckets <<= 1;
+  buckets_.reset(new Bucket[nbuckets]);
+  for (size_t i = 0; i < nbuckets; i++)
+    for (auto& slot : buckets_[i].slots)
+      slot.store(0, std::memory_order_relaxed);
+  bucket_mask_ = static_cast<uint32_t>(nbuckets - 1);
+
+  stats_.reset(new StatStripe[kStatStripes]);
+}
+
+BufferCache::~BufferCache() {
+  for (File& f : files_) {
+    if (f.map != nullptr)
+      ::munmap(const_cast<unsigned char*>(f.map), f.size);
+    ::close(f.fd);
+  }
+  std::free(frames_);
+}
+
+FileId BufferCache::add_file(const std::string& path) {
+  File f;
+  f.path = path;
+  f.fd = ::open(path.c_str(), O_RDONLY);
+  if (f.fd < 0)
+    throw_errno("could not open \"" + path + "\"");
+
+  if (mode_ == ReadMode::kMmap) {
+    struct stat st;
+    if (::fstat(f.fd, &st) < 0) {
+      ::close(f.fd);
+      throw_errno("could not stat \"" + path + "\"");
+    }
+    f.size = static_cast<size_t>(st.st_size);
+    if (f.size > 0) {
+      void* p = ::mmap(nullptr, f.size, PROT_READ, MAP_SHARED, f.fd, 0);
+      if (p == MAP_FAILED) {
+        ::close(f.fd);
+        throw_errno("could not map \"" + path + "\"");
+      }
+      f.map = static_cast<const unsigned char*>(p);
+    }
+  }
+
+  files_.push_back(std::move(f));
+  return static_cast<FileId>(files_.size() - 1);
+}
+
+unsigned char* BufferCache::frame(uint32_t buffer) const {
+  return frames_ + static_cast<size_t>(buffer) * kBlockSize;
+}
+
+uint32_t BufferCache::home_bucket(uint64_t tag) const {
+  // Fibonacci hashing; the high bits are the well-mixed ones.
+  uint64_t h = tag * 0x9E3779B97F4A7C15ULL;
+  return static_cast<uint32_t>(h >> 32) & bucket_mask_;
+}
+
+BufferCache::StatStripe& BufferCache::my_stats() {
+  static std::atomic<uint32_t> next_stripe{0};
+  thread_local uint32_t stripe =
+      next_stripe.fetch_add(1, std::memory_order_relaxed) % kStatStripes;
+  return stats_[stripe];
+}
+
+CacheStats BufferCache::stats() const {
+  CacheStats out;
+  for (size_t i = 0; i < kStatStripes; i++) {
+    out.hits += stats_[i].hits.load(std::memory_order_relaxed);
+    out.misses += stats_[i].misses.load(std::memory_order_relaxed);
+    out.evictions += stats_[i].evictions.load(std::memory_order_relaxed);
+  }
+  return out;
+}
+
+/*
+ * Pins buffer if it is not claimed by the clock sweep, then confirms that it
+ * still holds tag.  On success the caller owns one reference.
+ */
+bool BufferCache::try_pin(uint32_t buffer, uint64_t tag) {
+  Descriptor& d = descriptors_[buffer];
+  uint64_t state = d.state.load(std::memory_order_relaxed);
+  for (;;) {
+    if (state & kLocked)
+      return false;
+    uint64_t next = state + 1;
+    if (usage(state) < kMaxUsage)
+      next += kUsageOne;
+    if (d.state.compare_exchange_weak(state, next, std::memory_order_acquire,
+                                      std::memory_order_relaxed))
+      break;
+  }
+  if (d.tag.load(std::memory_order_acquire) != tag) {
+    unpin(buffer);
+    return false;
+  }
+  return true;
+}
+
+void BufferCache::unpin(uint32_t buffer) {
+  descriptors_[buffer].state.fetch_sub(1, std::memory_order_release);
+}
+
+/*
+ * Lock-free probe of the mapping table.  Returns the pinned buffer holding
+ * tag, or -1.  A free slot does not end the probe: the entry may have
+ * overflowed while that slot was still taken.
+ */
+int64_t BufferCache::lookup(uint64_t tag) {
+  uint32_t home = home_bucket(tag);
+  for (uint32_t p = 0; p < kMaxProbe; p++) {
+    Bucket& b = buckets_[(home + p) & bucket_mask_];
+    for (auto& slot : b.slots) {
+      uint32_t v = slot.load(std::memory_order_acquire);
+      if (v == 0)
+        continue;
+      uint32_t buffer = v - 1;
+      if (descriptors_[buffer].tag.load(std::memory_order_relaxed) == tag &&
+          try_pin(buffer, tag))
+        return buffer;
+    }
+  }
+  return -1;
+}
+
+void BufferCache::lock_bucket(uint32_t bucket) {
+  std::atomic<uint32_t>& lock = buckets_[bucket].lock;
+  for (;;) {
+    uint32_t expected = 0;
+    if (lock.compare_exchange_weak(expected, 1, std::memory_order_acquire,
+                                   std::memory_order_relaxed))
+      return;
+    // Holders only do a handful of slot updates, but may be preempted.
+    for (int spins = 0; lock.load(std::memory_order_relaxed) != 0; spins++) {
+      if (spins < 100)
+        cpu_relax();
+      else
+        std::this_thread::yield();
+    }
+  }
+}
+
+void BufferCache::unlock_bucket(uint32_t bucket) {
+  buckets_[bucket].lock.store(0, std::memory_order_release);
+}
+
+/*
+ * Like lookup(), but scans the full probe range and does not pin.  Caller
+ * holds the spin bit of tag's home bucket, so no other thread can be
+ * installing tag.  A LOCKED buffer still mapped under tag is on its way out
+ * and does not count.
+ */
+int64_t BufferCache::find_locked(uint64_t tag) {
+  uint32_t home = home_bucket(tag);
+  for (uint32_t p = 0; p < kMaxProbe; p++) {
+    Bucket& b = buckets_[(home + p) & bucket_mask_];
+    for (auto& slot : b.slots) {
+      uint32_t v = slot.load(std::memory_order_acquire);
+      if (v == 0)
+        continue;
+      const Descriptor& d = descriptors_[v - 1];
+      if (d.tag.load(std::memory_order_acquire) == tag &&
+          !(d.state.load(std::memory_order_acquire) & kLocked))
+        return v - 1;
+    }
+  }
+  return -1;
+}
+
+/*
+ * Publishes buffer under tag.  Caller holds the spin bit of tag's home
+ * bucket.  Overflow buckets can be shared with other home buckets, so slots
+ * are claimed with a CAS rather than a plain store.
+ */
+void BufferCache::insert_locked(uint64_t tag, uint32_t buffer) {
+  uint32_t home = home_bucket(tag);
+  for (uint32_t p = 0; p < kMaxProbe; p++) {
+    Bucket& b = buckets_[(home + p) & bucket_mask_];
+    for (auto& slot : b.slots) {
+      uint32_t expected = 0;
+      if (slot.load(std::memory_order_relaxed) == 0 &&
+          slot.compare_exchange_strong(expected, buffer + 1,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed))
+        return;
+    }
+  }
+  throw std::runtime_error("buffer mapping table overflow");
+}
+
+void BufferCache::remove_mapping(uint64_t tag, uint32_t buffer) {
+  uint32_t home = home_bucket(tag);
+  lock_bucket(home);
+  for (uint32_t p = 0; p < kMaxProbe; p++) {
+    Bucket& b = buckets_[(home + p) & bucket_mask_];
+    for (auto& slot : b.slots) {
+      uint32_t expected = buffer + 1;
+      if (slot.compare_exchange_strong(expected, 0,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+        unlock_bucket(home);
+        return;
+      }
+    }
+  }
+  unlock_bucket(home);
+}
+
+/*
+ * Advances the clock hand until it finds an unpinned buffer whose usage
+ * count has decayed to zero, and returns it LOCKED.
+ */
+uint32_t BufferCache::clock_sweep() {
+  // Every pass decrements usage counts by one, so kMaxUsage + 1 full passes
+  // without a victim means everything is pinned.
+  uint64_t budget = nbuffers_ * (kMaxUsage + 2);
+  while (budget-- > 0) {
+    uint32_t buffer = static_cast<uint32_t>(
+        clock_hand_.fetch_add(1, std::memory_order_relaxed) % nbuffers_);
+    Descriptor& d = descriptors_[buffer];
+    uint64_t state = d.state.load(std::memory_order_relaxed);
+    if ((state & kRefMask) != 0 || (state & (kLocked | kIoInProgress)))
+      continue;
+    if (usage(state) > 0) {
+      d.state.compare_exchange_weak(state, state - kUsageOne,
+                                    std::memory_order_relaxed);
+      continue;
+    }
+    if (d.state.compare_exchange_strong(state, kLocked,
+                                        std::memory_order_acquire,
+                                        std::memory_order_relaxed))
+      return buffer;
+  }
+  throw std::runtime_error("no unpinned buffers available");
+}
+
+void BufferCache::load_page(uint64_t tag, unsigned char* dst) {
+  const File& f = files_.at(static_cast<size_t>(tag >> 32));
+  BlockNumber blkno = static_cast<BlockNumber>(tag);
+  off_t offset = static_cast<off_t>(blkno) * kBlockSize;
+  StatTimer timer(StatHistogram::kPageRead);
+
+  if (mode_ == ReadMode::kMmap) {
+    if (static_cast<size_t>(offset) + kBlockSize > f.size) {
+      errno = ENXIO;
+      throw_errno("block " + std::to_string(blkno) +
+                  " is beyond the end of \"" + f.path + "\"");
+    }
+    std::memcpy(dst, f.map + offset, kBlockSize);
+    timer.add(StatCounter::kPageReads);
+    timer.add(StatCounter::kPageReadBytes, kBlockSize);
+    return;
+  }
+
+  size_t done = 0;
+  while (done < kBlockSize) {
+    ssize_t n = ::pread(f.fd, dst + done, kBlockSize - done,
+                        offset + static_cast<off_t>(done));
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      throw_errno("could not read block " + std::to_string(blkno) + " of \"" +
+                  f.path + "\"");
+    }
+    if (n == 0) {
+      errno = ENXIO;
+      throw_errno("block " + std::to_string(blkno) +
+                  " is beyond the end of \"" + f.path + "\"");
+    }
+    done += static_cast<size_t>(n);
+  }
+  timer.add(StatCounter::kPageReads);
+  timer.add(StatCounter::kPageReadBytes, kBlockSize);
+}
+
+PageRef BufferCache::read(FileId file, BlockNumber blkno) {
+  uint64_t tag = make_tag(file, blkno);
+  StatStripe& st = my_stats();
+
+  for (;;) {
+    int64_t hit = lookup(tag);
+    if (hit < 0) {
+      // Miss: claim a victim and drop its old mapping before touching the
+      // new home bucket, so that no thread ever holds two bucket spin bits.
+      uint32_t victim = clock_sweep();
+      Descriptor& d = descriptors_[victim];
+      uint64_t old_tag = d.tag.load(std::memory_order_relaxed);
+      if (old_tag != kNoTag) {
+        remove_mapping(old_tag, victim);
+        st.evictions.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      uint32_t home = home_bucket(tag);
+      lock_bucket(home);
+      int64_t found = find_locked(tag);
+      if (found >= 0) {
+        // Lost the race to install this block.  Pin the winner's buffer
+        // while its mapping cannot change, rather than going round again:
+        // each retry evicts another page and need not see the block either.
+        bool pinned = try_pin(static_cast<uint32_t>(found), tag);
+        unlock_bucket(home);
+        d.tag.store(kNoTag, std::memory_order_relaxed);
+        d.state.store(0, std::memory_order_release);
+        if (!pinned)
+          continue;
+        hit = found;
+      } else {
+        d.tag.store(tag, std::memory_order_relaxed);
+        d.state.store(kIoInProgress | kUsageOne | 1, std::memory_order_release);
+        try {
+          insert_locked(tag, victim);
+        } catch (...) {
+          unlock_bucket(home);
+          d.tag.store(kNoTag, std::memory_order_relaxed);
+          d.state.store(0, std::memory_order_release);
+          throw;
+        }
+        unlock_bucket(home);
+        st.misses.fetch_add(1, std::memory_order_relaxed);
+        stat_add(StatCounter::kCacheMisses);
+
+        try {
+          load_page(tag, frame(victim));
+        } catch (...) {
+          remove_mapping(tag, victim);
+          d.tag.store(kNoTag, std::memory_order_relaxed);
+          d.state.fetch_and(~kIoInProgress, std::memory_order_release);
+          unpin(victim);
+          throw;
+        }
+        d.state.fetch_or(kValid, std::memory_order_release);
+        d.state.fetch_and(~kIoInProgress, std::memory_order_release);
+        return PageRef(this, victim, frame(victim));
+      }
+    }
+
+    uint32_t buffer = static_cast<uint32_t>(hit);
+    Descriptor& d = descriptors_[buffer];
+    // Someone else may still be reading the page in.
+    uint64_t state;
+    while (((state = d.state.load(std::memory_order_acquire)) &
+            kIoInProgress) != 0)
+      std::this_thread::yield();
+    if (!(state & kValid)) {
+      // Their read failed; try again ourselves.
+      unpin(buffer);
+      continue;
+    }
+    st.hits.fetch_add(1, std::memory_order_relaxed);
+    stat_add(StatCounter::kCacheHits);
+    return PageRef(this, buffer, frame(buffer));
+  }
+}
+
+}  // namespace zs
@@ -0,0 +1,131 @@
+/*
+ * buffer_cache.h
+ *	  Shared cache of fixed-size pages for concurrent column scans.
+ *
+ * Pages are identified by (file, block).  Lookups never take a lock: the
+ * mapping table is scanned with plain atomic loads, and a hit is pinned by
+ * bumping the buffer's reference count with a CAS and then re-checking the
+ * buffer's tag.  Only changing the mapping (a miss installing a page, or an
+ * eviction removing one) takes a spin bit in the affected bucket, which is
+ * what guarantees a block is never cached twice.
+ *
+ * Replacement is clock-sweep: each buffer has a small usage count bumped on
+ * every pin and decayed by the sweeping hand; the first unpinned buffer with
+ * a zero count is the victim.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "storage/page.h"
+
+namespace zs {
+
+using FileId = uint32_t;
+
+struct CacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+};
+
+class BufferCache;
+
+// A pinned page.  The buffer cannot be evicted while a PageRef to it exists.
+class PageRef {
+ public:
+  PageRef() = default;
+  PageRef(PageRef&& other) noexcept;
+  PageRef& operator=(PageRef&& other) noexcept;
+  PageRef(const PageRef&) = delete;
+  PageRef& operator=(const PageRef&) = delete;
+  ~PageRef() { release(); }
+
+  const unsigned char* data() const { return data_; }
+  explicit operator bool() const { return cache_ != nullptr; }
+
+  void release();
+
+ private:
+  friend class BufferCache;
+  PageRef(BufferCache* cache, uint32_t buffer, const unsigned char* data)
+      : cache_(cache), buffer_(buffer), data_(data) {}
+
+  BufferCache* cache_ = nullptr;
+  uint32_t buffer_ = 0;
+  const unsigned char* data_ = nullptr;
+};
+
+class BufferCache {
+ public:
+  enum class ReadMode {
+    kPread,  // read misses with pread(2)
+    kMmap,   // copy misses out of a read-only mapping of the file
+  };
+
+  explicit BufferCache(size_t nbuffers, ReadMode mode = ReadMode::kPread);
+  ~BufferCache();
+
+  BufferCache(const BufferCache&) = delete;
+  BufferCache& operator=(const BufferCache&) = delete;
+
+  // Opens path read-only for use with read().  Files must be added before
+  // the cache is shared between threads.  Throws std::system_error.
+  FileId add_file(const std::string& path);
+
+  // Returns the page pinned, reading it in on a miss.  Safe to call from any
+  // number of threads.  Throws std::system_error if the read fails, and
+  // std::runtime_error if every buffer is pinned.
+  PageRef read(FileId file, BlockNumber blkno);
+
+  size_t nbuffers() const { return nbuffers_; }
+  ReadMode mode() const { return mode_; }
+
+  // Sums the per-thread counters.  Only approximate while reads are running.
+  CacheStats stats() const;
+
+ private:
+  friend class PageRef;
+
+  struct File;
+  struct Descriptor;
+  struct Bucket;
+
+  uint32_t home_bucket(uint64_t tag) const;
+  bool try_pin(uint32_t buffer, uint64_t tag);
+  void unpin(uint32_t buffer);
+  int64_t lookup(uint64_t tag);
+  uint32_t clock_sweep();
+  void lock_bucket(uint32_t bucket);
+  void unlock_bucket(uint32_t bucket);
+  int64_t find_locked(uint64_t tag);
+  void insert_locked(uint64_t tag, uint32_t buffer);
+  void remove_mapping(uint64_t tag, uint32_t buffer);
+  void load_page(uint64_t tag, unsigned char* dst);
+  unsigned char* frame(uint32_t buffer) const;
+
+  const size_t nbuffers_;
+  const ReadMode mode_;
+  std::vector<File> files_;
+  std::unique_ptr<Descriptor[]> descriptors_;
+  unsigned char* frames_ = nullptr;
+  std::unique_ptr<Bucket[]> buckets_;
+  uint32_t bucket_mask_;
+  std::atomic<uint64_t> clock_hand_{0};
+
+  struct alignas(64) StatStripe {
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> evictions{0};
+  };
+  static constexpr size_t kStatStripes = 64;
+  std::unique_ptr<StatStripe[]> stats_;
+  StatStripe& my_stats();
+};
+
+}  // namespace zs
@@ -0,0 +1,123 @@
+/*
+ * codec.h
+ *	  Lightweight integer compression for column pages.
+ *
+ * An encoded column chunk is an EncodedHeader followed by a codec-specific
+ * payload.  The bit-packed codecs (FOR, delta, bit-packing) share one
+ * payload layout: values are grouped into blocks of kPackBlockValues, and
+ * within a block value i goes to lane i % 4 and slot i / 4.  Each lane is
+ * packed LSB-first into bit_width 64-bit words, and the words of the four
+ * lanes are interleaved.  That layout lets a SIMD kernel unpack four
+ * consecutive values with a single uniform shift, so the same bytes decode
+ * equally well with the scalar, SSE4.2 or AVX2 kernels.
+ *
+ * Decoding is batch-at-a-time: Decoder hands back kDecodeBatchSize values
+ * per call, which is small enough to stay in L1 while the caller consumes
+ * them.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "codec/isa.h"
+
+namespace zs {
+
+enum class Codec : uint8_t {
+  kFor = 1,      // frame of reference: value - min, bit-packed
+  kDelta = 2,    // difference from the previous value, then FOR
+  kBitPack = 3,  // raw values bit-packed, no reference
+  kRle = 4,      // (value, run length) pairs
+};
+
+constexpr size_t kPackLanes = 4;
+constexpr size_t kPackBlockValues = 256;
+constexpr size_t kDecodeBatchSize = 1024;
+
+struct EncodedHeader {
+  uint8_t codec;
+  uint8_t bit_width;
+  uint16_t reserved;
+  uint32_t count;  // number of values
+  int64_t base;    // FOR minimum, or minimum delta
+  int64_t first;   // first value, for delta
+  uint32_t nruns;  // RLE only
+  uint32_t pad;
+};
+static_assert(sizeof(EncodedHeader) == 32, "EncodedHeader must stay 32 bytes");
+
+const char* codec_name(Codec codec);
+
+// Appends the encoding of values[0..n) to out.  Throws std::invalid_argument
+// if n does not fit in the header.
+void encode(Codec codec, const int64_t* values, size_t n,
+            std::vector<unsigned char>& out);
+
+// Size in bytes that encode() would produce.
+size_t encoded_size(Codec codec, const int64_t* values, size_t n);
+
+// Returns the codec giving the smallest encoding of values[0..n).
+Codec choose_codec(const int64_t* values, size_t n);
+
+// Tracks what encode() would produce for a growing run of values, one value
+// at a time.  Every codec's size is non-decreasing as values are added, so a
+// caller filling a page can stop at the first value that no longer fits.
+class ChunkSizer {
+ public:
+  void add(int64_t value);
+
+  size_t count() const { return count_; }
+  size_t size(Codec codec) const;
+  Codec best_codec() const;
+  size_t best_size() const { return size(best_codec()); }
+
+  int64_t min() const { return min_; }
+  int64_t max() const { return max_; }
+  uint64_t umax() const { return umax_; }
+  int64_t min_delta() const { return min_delta_; }
+  int64_t max_delta() const { return max_delta_; }
+  uint32_t nruns() const { return nruns_; }
+
+ private:
+  size_t count_ = 0;
+  int64_t min_ = 0;
+  int64_t max_ = 0;
+  uint64_t umax_ = 0;
+  int64_t min_delta_ = 0;  // deltas start from an implicit 0 for value 0
+  int64_t max_delta_ = 0;
+  int64_t last_ = 0;
+  uint32_t nruns_ = 0;
+};
+
+class Decoder {
+ public:
+  // data must stay valid for the lifetime of the decoder.  Throws
+  // std::runtime_error if the header is inconsistent with size, and
+  // std::invalid_argument if RLE run lengths do not add up to the count.
+  Decoder(const unsigned char* data, size_t size, Isa isa = best_isa());
+
+  size_t count() const { return header_.count; }
+  Codec codec() const { return static_cast<Codec>(header_.codec); }
+
+  // Decodes the next batch into out, which must have room for
+  // kDecodeBatchSize values.  Returns the number of values produced, 0 once
+  // the chunk is exhausted.
+  size_t next_batch(int64_t* out);
+
+  // Decodes the whole chunk; out must have room for count() values rounded
+  // up to kPackBlockValues.
+  void decode_all(int64_t* out);
+
+ private:
+  const unsigned char* payload_;
+  EncodedHeader header_;
+  const Kernels& kernels_;
+  size_t pos_ = 0;      // values produced so far
+  uint64_t carry_ = 0;  // delta: last value produced
+  uint32_t run_ = 0;    // RLE: current run
+  uint32_t run_pos_ = 0;
+};
+
+}  // namespace zs
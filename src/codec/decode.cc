@@ -0,0 +1,121 @@
+/*
+ * decode.cc
+ *	  Batch-at-a-time column chunk decoder.
+ */
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "codec/codec.h"
+#include "stats/stats.h"
+
+namespace zs {
+
+namespace {
+
+size_t packed_bytes(size_t n, unsigned bit_width) {
+  size_t nblocks = (n + kPackBlockValues - 1) / kPackBlockValues;
+  return nblocks * kPackLanes * bit_width * sizeof(uint64_t);
+}
+
+}  // namespace
+
+Decoder::Decoder(const unsigned char* data, size_t size, Isa isa)
+    : payload_(data + sizeof(EncodedHeader)), kernels_(kernels_for(isa)) {
+  if (size < sizeof(EncodedHeader))
+    throw std::runtime_error("encoded chunk too short");
+  std::memcpy(&header_, data, sizeof(header_));
+
+  size_t expected;
+  switch (codec()) {
+    case Codec::kFor:
+    case Codec::kDelta:
+    case Codec::kBitPack:
+      if (header_.bit_width > 64)
+        throw std::runtime_error("invalid bit width in encoded chunk");
+      expected = packed_bytes(header_.count, header_.bit_width);
+      break;
+    case Codec::kRle:
+      expected = header_.nruns * (sizeof(int64_t) + sizeof(uint32_t));
+      break;
+    default:
+      throw std::runtime_error("unknown codec in encoded chunk");
+  }
+  if (size - sizeof(EncodedHeader) < expected)
+    throw std::runtime_error("encoded chunk truncated");
+
+  if (codec() == Codec::kRle) {
+    // next_batch() trusts the runs to cover exactly count values; more would
+    // be silently dropped, fewer would read lengths past the payload.
+    const unsigned char* lengths = payload_ + header_.nruns * sizeof(int64_t);
+    uint64_t total = 0;
+    for (uint32_t r = 0; r < header_.nruns; r++) {
+      uint32_t len;
+      std::memcpy(&len, lengths + r * sizeof(len), sizeof(len));
+      total += len;
+    }
+    if (total != header_.count)
+      throw std::invalid_argument("RLE run lengths do not add up to count");
+  }
+
+  carry_ = static_cast<uint64_t>(header_.first);
+}
+
+size_t Decoder::next_batch(int64_t* out) {
+  size_t n = std::min(kDecodeBatchSize, header_.count - pos_);
+  if (n == 0)
+    return 0;
+  StatTimer timer(StatHistogram::kDecodeBatch);
+  timer.add(StatCounter::kDecodeBatches);
+  timer.add(StatCounter::kDecodeValues, n);
+  uint64_t* uout = reinterpret_cast<uint64_t*>(out);
+
+  switch (codec()) {
+    case Codec::kFor:
+    case Codec::kDelta:
+    case Codec::kBitPack: {
+      // pos_ is always a multiple of kDecodeBatchSize here, hence of the
+      // block size, so batches start on a block boundary.
+      size_t block_bytes = kPackLanes * header_.bit_width * sizeof(uint64_t);
+      size_t first_block = pos_ / kPackBlockValues;
+      size_t nblocks = (n + kPackBlockValues - 1) / kPackBlockValues;
+      kernels_.unpack(payload_ + first_block * block_bytes, header_.bit_width,
+                      nblocks, static_cast<uint64_t>(header_.base), uout);
+      if (codec() == Codec::kDelta)
+        carry_ = kernels_.prefix_sum(uout, n, carry_);
+      break;
+    }
+
+    case Codec::kRle: {
+      const unsigned char* lengths =
+          payload_ + header_.nruns * sizeof(int64_t);
+      size_t done = 0;
+      while (done < n) {
+        int64_t value;
+        uint32_t len;
+        std::memcpy(&value, payload_ + run_ * sizeof(value), sizeof(value));
+        std::memcpy(&len, lengths + run_ * sizeof(len), sizeof(len));
+        size_t take = std::min<size_t>(len - run_pos_, n - done);
+        kernels_.fill(uout + done, take, static_cast<uint64_t>(value));
+        done += take;
+        run_pos_ += static_cast<uint32_t>(take);
+        if (run_pos_ == len) {
+          run_++;
+          run_pos_ = 0;
+        }
+      }
+      break;
+    }
+  }
+
+  pos_ += n;
+  return n;
+}
+
+void Decoder::decode_all(int64_t* out) {
+  size_t n;
+  while ((n = next_batch(out)) > 0)
+    out += n;
+}
+
+}  // namespace zs
@@ -0,0 +1,221 @@
+/*
+ * encode.cc
+ *	  Column chunk encoders.  Encoding runs once per page at load time, so
+ *	  it is written for clarity rather than speed.
+ */
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "codec/codec.h"
+
+namespace zs {
+
+namespace {
+
+unsigned bits_needed(uint64_t v) {
+  return v == 0 ? 0 : 64 - static_cast<unsigned>(__builtin_clzll(v));
+}
+
+size_t packed_bytes(size_t n, unsigned bit_width) {
+  size_t nblocks = (n + kPackBlockValues - 1) / kPackBlockValues;
+  return nblocks * kPackLanes * bit_width * sizeof(uint64_t);
+}
+
+// Packs values[0..n) into the interleaved block layout described in codec.h,
+// zero-padding the last block.
+void pack(const uint64_t* values, size_t n, unsigned bit_width,
+          unsigned char* out) {
+  size_t nbytes = packed_bytes(n, bit_width);
+  std::memset(out, 0, nbytes);
+  if (bit_width == 0)
+    return;
+
+  size_t block_words = kPackLanes * bit_width;
+  for (size_t i = 0; i < n; i++) {
+    size_t block = i / kPackBlockValues;
+    size_t in_block = i % kPackBlockValues;
+    size_t lane = in_block % kPackLanes;
+    size_t bit = (in_block / kPackLanes) * bit_width;
+    size_t word = block * block_words + (bit / 64) * kPackLanes + lane;
+    unsigned shift = bit % 64;
+
+    uint64_t w;
+    std::memcpy(&w, out + word * 8, 8);
+    w |= values[i] << shift;
+    std::memcpy(out + word * 8, &w, 8);
+    if (shift + bit_width > 64) {
+      size_t next = word + kPackLanes;
+      std::memcpy(&w, out + next * 8, 8);
+      w |= values[i] >> (64 - shift);
+      std::memcpy(out + next * 8, &w, 8);
+    }
+  }
+}
+
+unsigned for_width(const ChunkSizer& st) {
+  return bits_needed(static_cast<uint64_t>(st.max()) -
+                     static_cast<uint64_t>(st.min()));
+}
+
+unsigned delta_width(const ChunkSizer& st) {
+  return bits_needed(static_cast<uint64_t>(st.max_delta()) -
+                     static_cast<uint64_t>(st.min_delta()));
+}
+
+ChunkSizer compute_stats(const int64_t* values, size_t n) {
+  ChunkSizer st;
+  for (size_t i = 0; i < n; i++)
+    st.add(values[i]);
+  return st;
+}
+
+}  // namespace
+
+void ChunkSizer::add(int64_t value) {
+  if (count_ == 0) {
+    min_ = max_ = value;
+    nruns_ = 1;
+  } else {
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+    if (value != last_)
+      nruns_++;
+    int64_t d = static_cast<int64_t>(static_cast<uint64_t>(value) -
+                                     static_cast<uint64_t>(last_));
+    min_delta_ = std::min(min_delta_, d);
+    max_delta_ = std::max(max_delta_, d);
+  }
+  umax_ = std::max(umax_, static_cast<uint64_t>(value));
+  last_ = value;
+  count_++;
+}
+
+size_t ChunkSizer::size(Codec codec) const {
+  switch (codec) {
+    case Codec::kFor:
+      return sizeof(EncodedHeader) + packed_bytes(count_, for_width(*this));
+    case Codec::kDelta:
+      return sizeof(EncodedHeader) + packed_bytes(count_, delta_width(*this));
+    case Codec::kBitPack:
+      return sizeof(EncodedHeader) + packed_bytes(count_, bits_needed(umax_));
+    case Codec::kRle:
+      return sizeof(EncodedHeader) +
+             nruns_ * (sizeof(int64_t) + sizeof(uint32_t));
+  }
+  throw std::invalid_argument("unknown codec " +
+                              std::to_string(static_cast<int>(codec)));
+}
+
+Codec ChunkSizer::best_codec() const {
+  Codec best = Codec::kFor;
+  size_t best_size = size(best);
+  for (Codec c : {Codec::kDelta, Codec::kBitPack, Codec::kRle}) {
+    size_t sz = size(c);
+    if (sz < best_size) {
+      best = c;
+      best_size = sz;
+    }
+  }
+  return best;
+}
+
+const char* codec_name(Codec codec) {
+  switch (codec) {
+    case Codec::kFor:
+      return "for";
+    case Codec::kDelta:
+      return "delta";
+    case Codec::kBitPack:
+      return "bitpack";
+    case Codec::kRle:
+      return "rle";
+  }
+  return "unknown";
+}
+
+size_t encoded_size(Codec codec, const int64_t* values, size_t n) {
+  return compute_stats(values, n).size(codec);
+}
+
+Codec choose_codec(const int64_t* values, size_t n) {
+  return compute_stats(values, n).best_codec();
+}
+
+void encode(Codec codec, const int64_t* values, size_t n,
+            std::vector<unsigned char>& out) {
+  if (n > std::numeric_limits<uint32_t>::max())
+    throw std::invalid_argument("too many values for one chunk: " +
+                                std::to_string(n));
+
+  ChunkSizer st = compute_stats(values, n);
+  EncodedHeader h{};
+  h.codec = static_cast<uint8_t>(codec);
+  h.count = static_cast<uint32_t>(n);
+
+  size_t start = out.size();
+  out.resize(start + st.size(codec));
+  unsigned char* payload = out.data() + start + sizeof(EncodedHeader);
+
+  std::vector<uint64_t> tmp;
+  switch (codec) {
+    case Codec::kFor:
+      h.bit_width = static_cast<uint8_t>(for_width(st));
+      h.base = st.min();
+      tmp.resize(n);
+      for (size_t i = 0; i < n; i++)
+        tmp[i] = static_cast<uint64_t>(values[i]) -
+                 static_cast<uint64_t>(h.base);
+      pack(tmp.data(), n, h.bit_width, payload);
+      break;
+
+    case Codec::kDelta:
+      h.bit_width = static_cast<uint8_t>(delta_width(st));
+      h.base = st.min_delta();
+      h.first = n > 0 ? values[0] : 0;
+      tmp.resize(n);
+      for (size_t i = 0; i < n; i++) {
+        uint64_t d = i == 0 ? 0
+                            : static_cast<uint64_t>(values[i]) -
+                                  static_cast<uint64_t>(values[i - 1]);
+        tmp[i] = d - static_cast<uint64_t>(h.base);
+      }
+      pack(tmp.data(), n, h.bit_width, payload);
+      break;
+
+    case Codec::kBitPack:
+      h.bit_width = static_cast<uint8_t>(bits_needed(st.umax()));
+      tmp.assign(reinterpret_cast<const uint64_t*>(values),
+                 reinterpret_cast<const uint64_t*>(values) + n);
+      pack(tmp.data(), n, h.bit_width, payload);
+      break;
+
+    case Codec::kRle: {
+      // Run values first, then run lengths, so both arrays stay aligned.
+      h.nruns = st.nruns();
+      unsigned char* lengths = payload + st.nruns() * sizeof(int64_t);
+      uint32_t run = 0;
+      for (size_t i = 0; i < n; i++) {
+        if (i > 0 && values[i] == values[i - 1]) {
+          uint32_t len;
+          std::memcpy(&len, lengths + (run - 1) * sizeof(len), sizeof(len));
+          len++;
+          std::memcpy(lengths + (run - 1) * sizeof(len), &len, sizeof(len));
+          continue;
+        }
+        uint32_t one = 1;
+        std::memcpy(payload + run * sizeof(int64_t), &values[i],
+                    sizeof(int64_t));
+        std::memcpy(lengths + run * sizeof(one), &one, sizeof(one));
+        run++;
+      }
+      break;
+    }
+  }
+
+  std::memcpy(out.data() + start, &h, sizeof(h));
+}
+
+}  // namespace zs
@@ -0,0 +1,58 @@
+/*
+ * isa.cc
+ *	  Runtime selection of the decode kernels.
+ */
+#include "codec/isa.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace zs {
+
+const char* isa_name(Isa isa) {
+  switch (isa) {
+    case Isa::kScalar:
+      return "scalar";
+    case Isa::kSse42:
+      return "sse4.2";
+    case Isa::kAvx2:
+      return "avx2";
+  }
+  return "unknown";
+}
+
+bool isa_supported(Isa isa) {
+  switch (isa) {
+    case Isa::kScalar:
+      return true;
+    case Isa::kSse42:
+      return __builtin_cpu_supports("sse4.2");
+    case Isa::kAvx2:
+      return __builtin_cpu_supports("avx2");
+  }
+  return false;
+}
+
+Isa best_isa() {
+  static const Isa best = isa_supported(Isa::kAvx2)    ? Isa::kAvx2
+                          : isa_supported(Isa::kSse42) ? Isa::kSse42
+                                                       : Isa::kScalar;
+  return best;
+}
+
+const Kernels& kernels_for(Isa isa) {
+  if (!isa_supported(isa))
+    throw std::invalid_argument(std::string("CPU does not support ") +
+                                isa_name(isa));
+  switch (isa) {
+    case Isa::kScalar:
+      break;
+    case Isa::kSse42:
+      return kSse42Kernels;
+    case Isa::kAvx2:
+      return kAvx2Kernels;
+  }
+  return kScalarKernels;
+}
+
+}  // namespace zs
@@ -0,0 +1,49 @@
+/*
+ * isa.h
+ *	  Runtime selection of the decode kernels.
+ *
+ * Each instruction set level has its own translation unit compiled with the
+ * matching -m flags; nothing outside that file may assume the CPU supports
+ * it.  best_isa() picks the highest level the running CPU reports.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace zs {
+
+enum class Isa {
+  kScalar,
+  kSse42,
+  kAvx2,
+};
+
+struct Kernels {
+  // Unpacks nblocks blocks of kPackBlockValues bit_width-bit values from in,
+  // adds base to each, and stores them to out in value order.
+  void (*unpack)(const unsigned char* in, unsigned bit_width, size_t nblocks,
+                 uint64_t base, uint64_t* out);
+
+  // Replaces values[i] by carry + values[0] + ... + values[i] and returns
+  // the new carry, values[n - 1].
+  uint64_t (*prefix_sum)(uint64_t* values, size_t n, uint64_t carry);
+
+  void (*fill)(uint64_t* out, size_t n, uint64_t value);
+};
+
+const char* isa_name(Isa isa);
+
+// Whether the running CPU can execute kernels for isa.
+bool isa_supported(Isa isa);
+
+Isa best_isa();
+
+// Throws std::invalid_argument if isa is not supported.
+const Kernels& kernels_for(Isa isa);
+
+extern const Kernels kScalarKernels;
+extern const Kernels kSse42Kernels;
+extern const Kernels kAvx2Kernels;
+
+}  // namespace zs
@@ -0,0 +1,102 @@
+/*
+ * kernels_avx2.cc
+ *	  AVX2 decode kernels.  Compiled with -mavx2; only reached through
+ *	  kernels_for() after a CPU check.
+ *
+ * One 256-bit register holds all four pack lanes, so each iteration of the
+ * unpack loop produces four consecutive output values.
+ */
+#include <immintrin.h>
+
+#include "codec/codec.h"
+
+namespace zs {
+
+namespace {
+
+void fill_avx2(uint64_t* out, size_t n, uint64_t value) {
+  __m256i v = _mm256_set1_epi64x(static_cast<long long>(value));
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+  for (; i < n; i++)
+    out[i] = value;
+}
+
+void unpack_avx2(const unsigned char* in, unsigned bit_width, size_t nblocks,
+                 uint64_t base, uint64_t* out) {
+  if (bit_width == 0) {
+    fill_avx2(out, nblocks * kPackBlockValues, base);
+    return;
+  }
+
+  const __m256i mask = _mm256_set1_epi64x(
+      bit_width == 64 ? -1LL : static_cast<long long>((1ULL << bit_width) - 1));
+  const __m256i vbase = _mm256_set1_epi64x(static_cast<long long>(base));
+  const size_t block_bytes = kPackLanes * bit_width * sizeof(uint64_t);
+
+  for (size_t b = 0; b < nblocks; b++) {
+    const __m256i* words =
+        reinterpret_cast<const __m256i*>(in + b * block_bytes);
+    __m256i cur = _mm256_loadu_si256(words);
+    unsigned word = 0;
+    unsigned shift = 0;
+
+    for (size_t slot = 0; slot < kPackBlockValues / kPackLanes; slot++) {
+      __m128i count = _mm_cvtsi32_si128(static_cast<int>(shift));
+      __m256i v = _mm256_srl_epi64(cur, count);
+
+      if (shift + bit_width >= 64) {
+        word++;
+        if (shift + bit_width > 64) {
+          // The value straddles two words: pull the rest from the next one.
+          cur = _mm256_loadu_si256(words + word);
+          v = _mm256_or_si256(
+              v, _mm256_sll_epi64(
+                     cur, _mm_cvtsi32_si128(static_cast<int>(64 - shift))));
+        } else if (word < bit_width) {
+          cur = _mm256_loadu_si256(words + word);
+        }
+        shift = shift + bit_width - 64;
+      } else {
+        shift += bit_width;
+      }
+
+      v = _mm256_add_epi64(_mm256_and_si256(v, mask), vbase);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + slot * kPackLanes),
+                          v);
+    }
+    out += kPackBlockValues;
+  }
+}
+
+uint64_t prefix_sum_avx2(uint64_t* values, size_t n, uint64_t carry) {
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i vcarry = _mm256_set1_epi64x(static_cast<long long>(carry));
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256i x =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+    // [a b c d] + [0 a b c] + [0 0 a a+b]
+    __m256i t = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(2, 1, 0, 0));
+    x = _mm256_add_epi64(x, _mm256_blend_epi32(t, zero, 0x03));
+    t = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 0, 0, 0));
+    x = _mm256_add_epi64(x, _mm256_blend_epi32(t, zero, 0x0F));
+    x = _mm256_add_epi64(x, vcarry);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), x);
+    vcarry = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 3, 3));
+  }
+  carry = static_cast<uint64_t>(
+      _mm256_extract_epi64(vcarry, 0));
+  for (; i < n; i++) {
+    carry += values[i];
+    values[i] = carry;
+  }
+  return carry;
+}
+
+}  // namespace
+
+const Kernels kAvx2Kernels = {unpack_avx2, prefix_sum_avx2, fill_avx2};
+
+}  // namespace zs
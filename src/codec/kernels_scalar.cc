@@ -0,0 +1,64 @@
+/*
+ * kernels_scalar.cc
+ *	  Portable decode kernels, used when no SIMD level is available and as
+ *	  the reference the SIMD kernels must agree with.
+ */
+#include <cstring>
+
+#include "codec/codec.h"
+
+namespace zs {
+
+namespace {
+
+inline uint64_t load_word(const unsigned char* p, size_t index) {
+  uint64_t w;
+  std::memcpy(&w, p + index * sizeof(uint64_t), sizeof(w));
+  return w;
+}
+
+void unpack_scalar(const unsigned char* in, unsigned bit_width,
+                   size_t nblocks, uint64_t base, uint64_t* out) {
+  size_t n = nblocks * kPackBlockValues;
+  if (bit_width == 0) {
+    for (size_t i = 0; i < n; i++)
+      out[i] = base;
+    return;
+  }
+
+  uint64_t mask = bit_width == 64 ? ~0ULL : (1ULL << bit_width) - 1;
+  size_t block_bytes = kPackLanes * bit_width * sizeof(uint64_t);
+  for (size_t b = 0; b < nblocks; b++) {
+    const unsigned char* words = in + b * block_bytes;
+    for (size_t i = 0; i < kPackBlockValues; i++) {
+      size_t lane = i % kPackLanes;
+      size_t bit = (i / kPackLanes) * bit_width;
+      size_t word = bit / 64;
+      unsigned shift = bit % 64;
+      uint64_t v = load_word(words, word * kPackLanes + lane) >> shift;
+      if (shift + bit_width > 64)
+        v |= load_word(words, (word + 1) * kPackLanes + lane) << (64 - shift);
+      out[i] = (v & mask) + base;
+    }
+    out += kPackBlockValues;
+  }
+}
+
+uint64_t prefix_sum_scalar(uint64_t* values, size_t n, uint64_t carry) {
+  for (size_t i = 0; i < n; i++) {
+    carry += values[i];
+    values[i] = carry;
+  }
+  return carry;
+}
+
+void fill_scalar(uint64_t* out, size_t n, uint64_t value) {
+  for (size_t i = 0; i < n; i++)
+    out[i] = value;
+}
+
+}  // namespace
+
+const Kernels kScalarKernels = {unpack_scalar, prefix_sum_scalar, fill_scalar};
+
+}  // namespace zs
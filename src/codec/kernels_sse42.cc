@@ -0,0 +1,101 @@
+/*
+ * kernels_sse42.cc
+ *	  SSE4.2 decode kernels.  Compiled with -msse4.2; only reached through
+ *	  kernels_for() after a CPU check.
+ *
+ * The four pack lanes are carried in two 128-bit registers.
+ */
+#include <nmmintrin.h>
+
+#include "codec/codec.h"
+
+namespace zs {
+
+namespace {
+
+void fill_sse42(uint64_t* out, size_t n, uint64_t value) {
+  __m128i v = _mm_set1_epi64x(static_cast<long long>(value));
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2)
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+  for (; i < n; i++)
+    out[i] = value;
+}
+
+void unpack_sse42(const unsigned char* in, unsigned bit_width, size_t nblocks,
+                  uint64_t base, uint64_t* out) {
+  if (bit_width == 0) {
+    fill_sse42(out, nblocks * kPackBlockValues, base);
+    return;
+  }
+
+  const __m128i mask = _mm_set1_epi64x(
+      bit_width == 64 ? -1LL : static_cast<long long>((1ULL << bit_width) - 1));
+  const __m128i vbase = _mm_set1_epi64x(static_cast<long long>(base));
+  const size_t block_bytes = kPackLanes * bit_width * sizeof(uint64_t);
+
+  for (size_t b = 0; b < nblocks; b++) {
+    const __m128i* words =
+        reinterpret_cast<const __m128i*>(in + b * block_bytes);
+    __m128i lo = _mm_loadu_si128(words);
+    __m128i hi = _mm_loadu_si128(words + 1);
+    unsigned word = 0;
+    unsigned shift = 0;
+
+    for (size_t slot = 0; slot < kPackBlockValues / kPackLanes; slot++) {
+      __m128i count = _mm_cvtsi32_si128(static_cast<int>(shift));
+      __m128i vlo = _mm_srl_epi64(lo, count);
+      __m128i vhi = _mm_srl_epi64(hi, count);
+
+      if (shift + bit_width >= 64) {
+        word++;
+        if (shift + bit_width > 64) {
+          // The value straddles two words: pull the rest from the next one.
+          __m128i back = _mm_cvtsi32_si128(static_cast<int>(64 - shift));
+          lo = _mm_loadu_si128(words + 2 * word);
+          hi = _mm_loadu_si128(words + 2 * word + 1);
+          vlo = _mm_or_si128(vlo, _mm_sll_epi64(lo, back));
+          vhi = _mm_or_si128(vhi, _mm_sll_epi64(hi, back));
+        } else if (word < bit_width) {
+          lo = _mm_loadu_si128(words + 2 * word);
+          hi = _mm_loadu_si128(words + 2 * word + 1);
+        }
+        shift = shift + bit_width - 64;
+      } else {
+        shift += bit_width;
+      }
+
+      vlo = _mm_add_epi64(_mm_and_si128(vlo, mask), vbase);
+      vhi = _mm_add_epi64(_mm_and_si128(vhi, mask), vbase);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + slot * kPackLanes),
+                       vlo);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + slot * kPackLanes + 2),
+                       vhi);
+    }
+    out += kPackBlockValues;
+  }
+}
+
+uint64_t prefix_sum_sse42(uint64_t* values, size_t n, uint64_t carry) {
+  __m128i vcarry = _mm_set1_epi64x(static_cast<long long>(carry));
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+    x = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+    x = _mm_add_epi64(x, vcarry);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), x);
+    vcarry = _mm_unpackhi_epi64(x, x);
+  }
+  carry = static_cast<uint64_t>(_mm_extract_epi64(vcarry, 0));
+  for (; i < n; i++) {
+    carry += values[i];
+    values[i] = carry;
+  }
+  return carry;
+}
+
+}  // namespace
+
+const Kernels kSse42Kernels = {unpack_sse42, prefix_sum_sse42, fill_sse42};
+
+}  // namespace zs
@@ -0,0 +1,84 @@
+/*
+ * arena.cc
+ *	  Per-batch bump allocator.
+ */
+#include "exec/arena.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace zs {
+
+namespace {
+
+// Offset at or after pos whose address in block is a multiple of align.
+size_t align_up(const unsigned char* block, size_t pos, size_t align) {
+  uintptr_t p = reinterpret_cast<uintptr_t>(block) + pos;
+  uintptr_t aligned = (p + align - 1) & ~(uintptr_t(align) - 1);
+  return pos + static_cast<size_t>(aligned - p);
+}
+
+}  // namespace
+
+Arena::Arena(size_t block_size) : block_size_(block_size) {}
+
+Arena::~Arena() {
+  for (Block& b : blocks_)
+    std::free(b.data);
+}
+
+void* Arena::allocate(size_t size, size_t align) {
+  if (current_ < blocks_.size()) {
+    Block& b = blocks_[current_];
+    size_t start = align_up(b.data, pos_, align);
+    if (start + size <= b.size) {
+      pos_ = start + size;
+      used_ += size;
+      return b.data + start;
+    }
+  }
+  return allocate_slow(size, align);
+}
+
+void* Arena::allocate_slow(size_t size, size_t align) {
+  // Move on to the next kept block that can hold the request, or make one.
+  size_t need = size + align - 1;
+  current_++;
+  while (current_ < blocks_.size() && blocks_[current_].size < need)
+    current_++;
+  if (current_ >= blocks_.size()) {
+    add_block(std::max(block_size_, need));
+    current_ = blocks_.size() - 1;
+  }
+  Block& b = blocks_[current_];
+  size_t start = align_up(b.data, 0, align);
+  pos_ = start + size;
+  used_ += size;
+  return b.data + start;
+}
+
+void Arena::add_block(size_t size) {
+  unsigned char* data = static_cast<unsigned char*>(std::malloc(size));
+  if (data == nullptr)
+    throw std::bad_alloc();
+  blocks_.push_back(Block{data, size});
+  reserved_ += size;
+  block_allocations_++;
+}
+
+void Arena::reset() {
+  if (blocks_.size() > 1) {
+    size_t total = reserved_;
+    for (Block& b : blocks_)
+      std::free(b.data);
+    blocks_.clear();
+    reserved_ = 0;
+    add_block(total);
+  }
+  current_ = 0;
+  pos_ = 0;
+  used_ = 0;
+}
+
+}  // namespace zs
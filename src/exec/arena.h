@@ -0,0 +1,64 @@
+/*
+ * arena.h
+ *	  Bump allocator for memory that lives exactly as long as one batch.
+ *
+ * Everything allocated while processing a batch is released at once by
+ * reset(), which only rewinds a pointer.  Blocks obtained from malloc are
+ * kept across resets, and if a batch spilled into more than one block they
+ * are merged into a single block big enough for the whole batch, so a loop
+ * over batches of similar size stops calling malloc after the first one.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zs {
+
+class Arena {
+ public:
+  static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+  explicit Arena(size_t block_size = kDefaultBlockSize);
+  ~Arena();
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // Returns size bytes aligned to align, which must be a power of two.
+  // Throws std::bad_alloc.
+  void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+  template <typename T>
+  T* allocate_array(size_t n) {
+    return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+  }
+
+  // Invalidates everything allocated so far.
+  void reset();
+
+  size_t bytes_used() const { return used_; }
+  size_t bytes_reserved() const { return reserved_; }
+  // Number of blocks obtained from malloc over the arena's lifetime.
+  uint64_t block_allocations() const { return block_allocations_; }
+
+ private:
+  struct Block {
+    unsigned char* data;
+    size_t size;
+  };
+
+  void* allocate_slow(size_t size, size_t align);
+  void add_block(size_t size);
+
+  size_t block_size_;
+  std::vector<Block> blocks_;
+  size_t current_ = 0;  // block being carved
+  size_t pos_ = 0;      // offset into it
+  size_t used_ = 0;
+  size_t reserved_ = 0;
+  uint64_t block_allocations_ = 0;
+};
+
+}  // namespace zs
@@ -0,0 +1,139 @@
+/*
+ * materialize.cc
+ *	  Column-at-a-time row construction into an arena.
+ */
+#include "exec/materialize.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace zs {
+
+namespace {
+
+// Copies the selected values of one column into their slot of each row.
+// The common widths get a fixed-size copy the compiler can turn into a
+// single load and store; rows carry no padding, so the stores may be
+// unaligned.
+template <size_t N>
+void gather_fixed(const unsigned char* src, const uint32_t* sel, size_t n,
+                  unsigned char* dst, size_t stride) {
+  for (size_t i = 0; i < n; i++)
+    std::memcpy(dst + i * stride, src + static_cast<size_t>(sel[i]) * N, N);
+}
+
+template <size_t N>
+void copy_fixed(const unsigned char* src, size_t n, unsigned char* dst,
+                size_t stride) {
+  for (size_t i = 0; i < n; i++)
+    std::memcpy(dst + i * stride, src + i * N, N);
+}
+
+void gather(const unsigned char* src, size_t attlen, const uint32_t* sel,
+            size_t n, unsigned char* dst, size_t stride) {
+  switch (attlen) {
+    case 1:
+      gather_fixed<1>(src, sel, n, dst, stride);
+      break;
+    case 2:
+      gather_fixed<2>(src, sel, n, dst, stride);
+      break;
+    case 4:
+      gather_fixed<4>(src, sel, n, dst, stride);
+      break;
+    case 8:
+      gather_fixed<8>(src, sel, n, dst, stride);
+      break;
+    default:
+      for (size_t i = 0; i < n; i++)
+        std::memcpy(dst + i * stride, src + sel[i] * attlen, attlen);
+      break;
+  }
+}
+
+void copy(const unsigned char* src, size_t attlen, size_t n,
+          unsigned char* dst, size_t stride) {
+  switch (attlen) {
+    case 1:
+      copy_fixed<1>(src, n, dst, stride);
+      break;
+    case 2:
+      copy_fixed<2>(src, n, dst, stride);
+      break;
+    case 4:
+      copy_fixed<4>(src, n, dst, stride);
+      break;
+    case 8:
+      copy_fixed<8>(src, n, dst, stride);
+      break;
+    default:
+      for (size_t i = 0; i < n; i++)
+        std::memcpy(dst + i * stride, src + i * attlen, attlen);
+      break;
+  }
+}
+
+}  // namespace
+
+void Materializer::check_columns(
+    const std::vector<ColumnVector>& columns) const {
+  if (columns.size() != static_cast<size_t>(schema_.natts()))
+    throw std::invalid_argument("column count does not match the schema");
+  for (int attno = 0; attno < schema_.natts(); attno++)
+    if (columns[attno].attlen != schema_.attlen(attno))
+      throw std::invalid_argument(
+          "column " + std::to_string(attno) + " is " +
+          std::to_string(columns[attno].attlen) + " bytes wide, schema has " +
+          std::to_string(schema_.attlen(attno)));
+}
+
+TupleBatch Materializer::allocate(size_t n, Arena& arena) const {
+  TupleBatch out;
+  out.ntuples = n;
+  out.row_width = schema_.row_width();
+  out.rows = arena.allocate_array<unsigned char>(n * out.row_width);
+  out.tuples = arena.allocate_array<const unsigned char*>(n);
+  for (size_t i = 0; i < n; i++)
+    out.tuples[i] = out.rows + i * out.row_width;
+  return out;
+}
+
+TupleBatch Materializer::materialize(const std::vector<ColumnVector>& columns,
+                                     const uint32_t* sel, size_t nsel,
+                                     Arena& arena) const {
+  check_columns(columns);
+  TupleBatch out = allocate(nsel, arena);
+  for (int attno = 0; attno < schema_.natts(); attno++)
+    gather(columns[attno].data, schema_.attlen(attno), sel, nsel,
+           out.rows + schema_.offset(attno), out.row_width);
+  return out;
+}
+
+TupleBatch Materializer::materialize_all(
+    const std::vector<ColumnVector>& columns, size_t nrows,
+    Arena& arena) const {
+  check_columns(columns);
+  TupleBatch out = allocate(nrows, arena);
+  for (int attno = 0; attno < schema_.natts(); attno++)
+    copy(columns[attno].data, schema_.attlen(attno), nrows,
+         out.rows + schema_.offset(attno), out.row_width);
+  return out;
+}
+
+std::vector<ColumnVector> column_vectors(const ScanBatch& batch,
+                                         const Schema& schema) {
+  if (batch.columns.size() != static_cast<size_t>(schema.natts()))
+    throw std::invalid_argument("batch has " +
+                                std::to_string(batch.columns.size()) +
+                                " columns, projection has " +
+                                std::to_string(schema.natts()));
+  std::vector<ColumnVector> out;
+  out.reserve(batch.columns.size());
+  for (size_t i = 0; i < batch.columns.size(); i++)
+    out.push_back(ColumnVector{batch.columns[i].data(),
+                               schema.attlen(static_cast<int>(i))});
+  return out;
+}
+
+}  // namespace zs
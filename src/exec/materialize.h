@@ -0,0 +1,76 @@
+/*
+ * materialize.h
+ *	  Late materialization: building rows from column vectors only for the
+ *	  positions that survived filtering.
+ *
+ * A columnar scan produces one vector per projected attribute.  Filters run
+ * on those vectors directly and leave behind a selection vector, the
+ * ascending positions of the rows that qualify.  Only then are rows put
+ * together, and only for the selected positions, so a selective query over
+ * a wide table never copies the attributes of rows it throws away.
+ *
+ * Output rows are in Schema row format and are carved out of an Arena,
+ * together with the tuple pointer array, so materializing a batch costs no
+ * per-row allocation; resetting the arena before the next batch frees them
+ * all.  Rows are filled one column at a time, which streams through each
+ * input vector in order.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "exec/arena.h"
+#include "storage/schema.h"
+#include "storage/table_scan.h"
+
+namespace zs {
+
+// nrows fixed-width values of one attribute, packed back to back.
+struct ColumnVector {
+  const unsigned char* data;
+  uint16_t attlen;
+};
+
+// Rows of one batch.  tuples[i] points at the i'th row, which comes from
+// input position sel[i]; the rows are also laid out contiguously at rows.
+struct TupleBatch {
+  size_t ntuples = 0;
+  size_t row_width = 0;
+  unsigned char* rows = nullptr;
+  const unsigned char** tuples = nullptr;
+};
+
+class Materializer {
+ public:
+  // schema describes the output rows; its attributes correspond one to one
+  // with the column vectors passed in.
+  explicit Materializer(Schema schema) : schema_(std::move(schema)) {}
+
+  // Builds the rows at positions sel[0..nsel) of columns in arena.  The
+  // result stays valid until the arena is reset.  Throws
+  // std::invalid_argument if columns do not match the schema in number or
+  // in attribute widths.
+  TupleBatch materialize(const std::vector<ColumnVector>& columns,
+                         const uint32_t* sel, size_t nsel, Arena& arena) const;
+
+  // Builds every row of the batch, positions 0..nrows.
+  TupleBatch materialize_all(const std::vector<ColumnVector>& columns,
+                             size_t nrows, Arena& arena) const;
+
+  const Schema& schema() const { return schema_; }
+
+ private:
+  void check_columns(const std::vector<ColumnVector>& columns) const;
+  TupleBatch allocate(size_t n, Arena& arena) const;
+
+  Schema schema_;
+};
+
+// Views of a TableScan batch's columns; schema describes the projection.
+// Throws std::invalid_argument if the column counts differ.
+std::vector<ColumnVector> column_vectors(const ScanBatch& batch,
+                                         const Schema& schema);
+
+}  // namespace zs
@@ -0,0 +1,385 @@
+/*
+ * bulk_loader.cc
+ *	  Builds a zedstore file bottom-up from rows supplied in TID order.
+ */
+#include "loader/bulk_loader.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "codec/codec.h"
+#include "storage/errors.h"
+#include "storage/relation.h"
+
+namespace zs {
+
+namespace {
+
+// Leaves are written this many at a time, as one contiguous run of blocks,
+// so that a column's leaf level stays mostly sequential on disk even though
+// all columns are written concurrently.
+constexpr size_t kExtentPages = 16;
+
+constexpr size_t kLeafPayload = kBlockSize - sizeof(PageHeader);
+
+}  // namespace
+
+/*
+ * The output file.  Blocks are handed out with an atomic counter, and all
+ * writes are positional, so any number of workers can write at once.
+ */
+class BulkLoader::ExtentFile {
+ public:
+  explicit ExtentFile(const std::string& path) : path_(path) {
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0)
+      throw_errno("could not create \"" + path + "\"");
+  }
+  ~ExtentFile() { ::close(fd_); }
+
+  BlockNumber reserve(size_t n) {
+    return next_block_.fetch_add(static_cast<BlockNumber>(n),
+                                 std::memory_order_relaxed);
+  }
+
+  void write(BlockNumber first, const void* data, size_t nbytes,
+             off_t offset_in_block = 0) {
+    off_t offset = static_cast<off_t>(first) * kBlockSize + offset_in_block;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    size_t done = 0;
+    while (done < nbytes) {
+      ssize_t n = ::pwrite(fd_, p + done, nbytes - done,
+                           offset + static_cast<off_t>(done));
+      if (n < 0) {
+        if (errno == EINTR)
+          continue;
+        throw_errno("could not write to \"" + path_ + "\"");
+      }
+      done += static_cast<size_t>(n);
+    }
+  }
+
+  void write_pages(BlockNumber first, const Page* pages, size_t n) {
+    write(first, pages, n * kBlockSize);
+    pages_written_.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  // Points the right-link of an already written page at next.  The page
+  // was counted when it was first written, so this does not count again.
+  void patch_next(BlockNumber blkno, BlockNumber next) {
+    write(blkno, &next, sizeof(next), offsetof(PageHeader, next));
+  }
+
+  void sync() {
+    if (::fsync(fd_) < 0)
+      throw_errno("could not fsync \"" + path_ + "\"");
+  }
+
+  uint64_t pages_written() const { return pages_written_.load(); }
+  uint64_t bytes_written() const { return pages_written() * kBlockSize; }
+
+ private:
+  int fd_;
+  std::string path_;
+  std::atomic<BlockNumber> next_block_{kMetaBlock + 1};
+  std::atomic<uint64_t> pages_written_{0};
+};
+
+/*
+ * Writes one level of one tree left to right, linking siblings and
+ * remembering a downlink for each page for the level above.
+ */
+class BulkLoader::LevelWriter {
+ public:
+  explicit LevelWriter(ExtentFile& file) : file_(file) {
+    pending_.reserve(kExtentPages);
+  }
+
+  void add(const Page& page) {
+    pending_.push_back(page);
+    if (pending_.size() == kExtentPages)
+      flush();
+  }
+
+  void flush() {
+    if (pending_.empty())
+      return;
+    size_t n = pending_.size();
+    BlockNumber first = file_.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+      PageHeader* h = pending_[i].header();
+      h->next = i + 1 < n ? first + static_cast<BlockNumber>(i + 1)
+                          : kInvalidBlock;
+      downlinks_.push_back(
+          InternalItem{h->first_tid, first + static_cast<BlockNumber>(i), 0});
+    }
+    if (last_ != kInvalidBlock)
+      file_.patch_next(last_, first);
+    file_.write_pages(first, pending_.data(), n);
+    last_ = first + static_cast<BlockNumber>(n - 1);
+    pending_.clear();
+  }
+
+  const std::vector<InternalItem>& downlinks() const { return downlinks_; }
+
+ private:
+  ExtentFile& file_;
+  std::vector<Page> pending_;
+  std::vector<InternalItem> downlinks_;
+  BlockNumber last_ = kInvalidBlock;
+};
+
+struct BulkLoader::ColumnBuilder {
+  ColumnBuilder(ExtentFile& file, uint16_t attlen)
+      : attlen(attlen), leaves(file) {}
+
+  uint16_t attlen;
+  std::vector<int64_t> pending;  // values not yet placed on a leaf
+  zstid pending_first = kMinTid;
+  LevelWriter leaves;
+  std::vector<unsigned char> encoded;
+};
+
+BulkLoader::BulkLoader(const std::string& path, const Schema& schema,
+                       const LoadOptions& opts)
+    : schema_(schema), opts_(opts), pool_(opts.workers) {
+  if (schema.natts() == 0 ||
+      static_cast<size_t>(schema.natts()) > kMaxAttributes)
+    throw std::invalid_argument("unsupported number of attributes: " +
+                                std::to_string(schema.natts()));
+  for (int i = 0; i < schema.natts(); i++)
+    if (schema.attlen(i) != sizeof(int32_t) &&
+        schema.attlen(i) != sizeof(int64_t))
+      throw std::invalid_argument("bulk load supports only 4 and 8 byte "
+                                  "attributes, attribute " +
+                                  std::to_string(i) + " is " +
+                                  std::to_string(schema.attlen(i)));
+
+  file_ = std::make_unique<ExtentFile>(path);
+  for (int i = 0; i < schema.natts(); i++)
+    columns_.push_back(
+        std::make_unique<ColumnBuilder>(*file_, schema.attlen(i)));
+}
+
+BulkLoader::~BulkLoader() = default;
+
+/*
+ * Cuts col.pending into leaves.  A leaf is compressed with whichever codec
+ * packs the most values into a page, unless the values compress so poorly
+ * that a plain leaf holds more.  Values that do not yet fill a leaf stay
+ * pending for the next batch, unless this is the final call.
+ */
+void BulkLoader::emit_leaves(ColumnBuilder& col, bool final) {
+  const size_t raw_capacity = page_capacity(col.attlen);
+  size_t pos = 0;
+
+  while (pos < col.pending.size()) {
+    size_t avail = col.pending.size() - pos;
+    const int64_t* values = col.pending.data() + pos;
+
+    ChunkSizer sizer;
+    size_t n = 0;
+    bool full = false;
+    while (n < avail) {
+      sizer.add(values[n]);
+      if (sizer.best_size() > kLeafPayload) {
+        full = true;
+        break;
+      }
+      if (++n == kMaxLeafValues) {
+        full = true;
+        break;
+      }
+    }
+
+    Page page;
+    std::memset(page.data, 0, kBlockSize);
+    page.init(kLeafPage, 0, col.attlen);
+    page.header()->first_tid = col.pending_first + pos;
+
+    if (full && n < raw_capacity) {
+      // Incompressible run: a plain leaf does better.
+      if (avail < raw_capacity && !final)
+        break;
+      n = std::min(avail, raw_capacity);
+      if (col.attlen == sizeof(int64_t)) {
+        std::memcpy(page.items(), values, n * sizeof(int64_t));
+      } else {
+        for (size_t i = 0; i < n; i++) {
+          int32_t v = static_cast<int32_t>(values[i]);
+          std::memcpy(page.items() + i * sizeof(v), &v, sizeof(v));
+        }
+      }
+    } else {
+      if (!full && !final)
+        break;
+      col.encoded.clear();
+      encode(choose_codec(values, n), values, n, col.encoded);
+      std::memcpy(page.items(), col.encoded.data(), col.encoded.size());
+      page.header()->flags = kLeafCompressed;
+    }
+    page.header()->nitems = static_cast<uint32_t>(n);
+    col.leaves.add(page);
+    pos += n;
+  }
+
+  col.pending.erase(col.pending.begin(), col.pending.begin() + pos);
+  col.pending_first += pos;
+}
+
+void BulkLoader::add(const std::vector<ColumnBatch>& batches) {
+  if (finished_)
+    throw std::logic_error("BulkLoader::add() after finish()");
+  // Validate everything up front, so that a bad batch leaves every column
+  // untouched instead of some columns a batch ahead of the others.
+  for (const ColumnBatch& batch : batches) {
+    if (batch.columns.size() != static_cast<size_t>(schema_.natts()))
+      throw std::invalid_argument("batch has " +
+                                  std::to_string(batch.columns.size()) +
+                                  " columns, table has " +
+                                  std::to_string(schema_.natts()));
+    for (size_t attno = 0; attno < batch.columns.size(); attno++)
+      if (batch.columns[attno].size() != batch.nrows)
+        throw std::invalid_argument(
+            "column " + std::to_string(attno) + " has " +
+            std::to_string(batch.columns[attno].size()) +
+            " values, batch has " + std::to_string(batch.nrows) + " rows");
+  }
+  // Plain leaves store 4-byte values truncated while compressed leaves keep
+  // all 64 bits, so an out-of-range value would read back differently
+  // depending on where it landed.
+  pool_.parallel_for(columns_.size(), [&](size_t attno) {
+    if (columns_[attno]->attlen != sizeof(int32_t))
+      return;
+    for (const ColumnBatch& batch : batches)
+      for (int64_t v : batch.columns[attno])
+        if (v < std::numeric_limits<int32_t>::min() ||
+            v > std::numeric_limits<int32_t>::max())
+          throw std::invalid_argument("value " + std::to_string(v) +
+                                      " does not fit 4-byte column " +
+                                      std::to_string(attno));
+  });
+
+  pool_.parallel_for(columns_.size(), [&](size_t attno) {
+    ColumnBuilder& col = *columns_[attno];
+    for (const ColumnBatch& batch : batches) {
+      const std::vector<int64_t>& values = batch.columns[attno];
+      col.pending.insert(col.pending.end(), values.begin(), values.end());
+    }
+    emit_leaves(col, false);
+  });
+
+  for (const ColumnBatch& batch : batches)
+    rows_ += batch.nrows;
+}
+
+/*
+ * Builds internal levels above a finished level until one page remains, and
+ * returns the root.
+ */
+BlockNumber BulkLoader::build_upper_levels(LevelWriter& leaves) {
+  leaves.flush();
+  std::vector<InternalItem> level = leaves.downlinks();
+  if (level.empty())
+    return kInvalidBlock;
+
+  const size_t capacity = page_capacity(sizeof(InternalItem));
+  uint16_t height = 0;
+  while (level.size() > 1) {
+    height++;
+    LevelWriter writer(*file_);
+    for (size_t i = 0; i < level.size(); i += capacity) {
+      size_t n = std::min(capacity, level.size() - i);
+      Page page;
+      std::memset(page.data, 0, kBlockSize);
+      page.init(kInternalPage, height, sizeof(InternalItem));
+      page.header()->first_tid = level[i].tid;
+      page.header()->nitems = static_cast<uint32_t>(n);
+      std::memcpy(page.items(), &level[i], n * sizeof(InternalItem));
+      writer.add(page);
+    }
+    writer.flush();
+    level = writer.downlinks();
+  }
+  return level[0].child;
+}
+
+// Every loaded row gets the same visibility, so the TID tree is generated
+// rather than fed.
+BlockNumber BulkLoader::build_tid_tree() {
+  const uint32_t capacity = page_capacity(sizeof(TidItem));
+  const TidItem item{opts_.xid, kInvalidXid};
+  LevelWriter leaves(*file_);
+
+  for (uint64_t done = 0; done < rows_; done += capacity) {
+    uint32_t n = static_cast<uint32_t>(std::min<uint64_t>(capacity,
+                                                          rows_ - done));
+    Page page;
+    std::memset(page.data, 0, kBlockSize);
+    page.init(kLeafPage, 0, sizeof(TidItem));
+    page.header()->first_tid = kMinTid + done;
+    page.header()->nitems = n;
+    for (uint32_t i = 0; i < n; i++)
+      std::memcpy(page.items() + i * sizeof(item), &item, sizeof(item));
+    leaves.add(page);
+  }
+  return build_upper_levels(leaves);
+}
+
+void BulkLoader::write_meta(BlockNumber tid_root,
+                            const std::vector<BlockNumber>& roots) {
+  Page meta;
+  std::memset(meta.data, 0, kBlockSize);
+
+  MetaPageData data{};
+  data.magic = kZedstoreMagic;
+  data.version = kZedstoreVersion;
+  data.natts = static_cast<uint16_t>(schema_.natts());
+  data.next_tid = kMinTid + rows_;
+  data.tid_root = tid_root;
+  std::memcpy(meta.data, &data, sizeof(data));
+
+  for (int i = 0; i < schema_.natts(); i++) {
+    MetaAttribute att{schema_.attlen(i), 0, roots[i]};
+    std::memcpy(meta.data + sizeof(data) + i * sizeof(att), &att, sizeof(att));
+  }
+  file_->write_pages(kMetaBlock, &meta, 1);
+}
+
+LoadStats BulkLoader::finish() {
+  if (finished_)
+    throw std::logic_error("BulkLoader::finish() called twice");
+  finished_ = true;
+
+  // One task per column plus one for the TID tree.
+  std::vector<BlockNumber> roots(columns_.size(), kInvalidBlock);
+  BlockNumber tid_root = kInvalidBlock;
+  pool_.parallel_for(columns_.size() + 1, [&](size_t task) {
+    if (task == columns_.size()) {
+      tid_root = build_tid_tree();
+      return;
+    }
+    ColumnBuilder& col = *columns_[task];
+    emit_leaves(col, true);
+    roots[task] = build_upper_levels(col.leaves);
+  });
+
+  write_meta(tid_root, roots);
+  file_->sync();
+
+  LoadStats stats;
+  stats.rows = rows_;
+  stats.pages_written = file_->pages_written();
+  stats.bytes_written = file_->bytes_written();
+  return stats;
+}
+
+}  // namespace zs
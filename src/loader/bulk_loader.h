@@ -0,0 +1,89 @@
+/*
+ * bulk_loader.h
+ *	  Builds a zedstore file bottom-up from rows supplied in TID order.
+ *
+ * The insert path descends every tree once per row.  The bulk loader
+ * instead treats each column as a stream: values are packed into
+ * compressed leaves as they arrive, leaves are written out in contiguous
+ * extents, and once the input ends the internal levels are built from the
+ * list of leaf downlinks, one level at a time.  Columns are independent
+ * until the metapage is written, so every step runs on a worker pool with
+ * one task per column.
+ *
+ * The result is an ordinary zedstore file that Relation::open() reads; new
+ * rows inserted afterwards simply start fresh, uncompressed leaves.
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "loader/worker_pool.h"
+#include "storage/page.h"
+#include "storage/schema.h"
+
+namespace zs {
+
+// Most values one compressed leaf may hold.  Bounds the buffer a scan
+// decodes a leaf into.
+constexpr size_t kMaxLeafValues = 16384;
+
+struct LoadOptions {
+  int workers = 1;
+  TransactionId xid = 1;  // xmin of every loaded row
+};
+
+struct LoadStats {
+  uint64_t rows = 0;
+  uint64_t pages_written = 0;
+  uint64_t bytes_written = 0;
+};
+
+// Consecutive rows, already split by column: columns[attno][row].  Values of
+// 4-byte attributes must fit in int32_t.
+struct ColumnBatch {
+  size_t nrows = 0;
+  std::vector<std::vector<int64_t>> columns;
+};
+
+class BulkLoader {
+ public:
+  // Creates (truncating) path.  Every attribute must be 4 or 8 bytes wide.
+  // Throws std::invalid_argument or std::system_error.
+  BulkLoader(const std::string& path, const Schema& schema,
+             const LoadOptions& opts);
+  ~BulkLoader();
+
+  // Appends batches, in order, as the next rows of the table.  Throws
+  // std::invalid_argument, appending nothing, if a batch does not match the
+  // schema or a 4-byte attribute's value does not fit in int32_t.
+  void add(const std::vector<ColumnBatch>& batches);
+
+  // Writes out everything still buffered, builds the internal levels of
+  // every tree and writes the metapage.  The loader is unusable afterwards.
+  LoadStats finish();
+
+  const Schema& schema() const { return schema_; }
+  WorkerPool& pool() { return pool_; }
+
+ private:
+  class ExtentFile;
+  class LevelWriter;
+  struct ColumnBuilder;
+
+  void emit_leaves(ColumnBuilder& col, bool final);
+  BlockNumber build_upper_levels(LevelWriter& leaves);
+  BlockNumber build_tid_tree();
+  void write_meta(BlockNumber tid_root, const std::vector<BlockNumber>& roots);
+
+  Schema schema_;
+  LoadOptions opts_;
+  WorkerPool pool_;
+  std::unique_ptr<ExtentFile> file_;
+  std::vector<std::unique_ptr<ColumnBuilder>> columns_;
+  uint64_t rows_ = 0;
+  bool finished_ = false;
+};
+
+}  // namespace zs
@@ -0,0 +1,239 @@
+/*
+ * input.cc
+ *	  Input formats for the bulk loader.
+ */
+#include "loader/input.h"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "storage/errors.h"
+
+namespace zs {
+
+namespace {
+
+// Slices per worker; more than one evens out uneven line lengths.
+constexpr size_t kSlicesPerWorker = 4;
+
+size_t read_fully(std::FILE* in, unsigned char* buf, size_t len) {
+  size_t got = std::fread(buf, 1, len, in);
+  if (got < len && std::ferror(in))
+    throw_errno("could not read input");
+  return got;
+}
+
+ColumnBatch empty_batch(const Schema& schema) {
+  ColumnBatch batch;
+  batch.columns.resize(schema.natts());
+  return batch;
+}
+
+std::string excerpt(const char* begin, const char* end) {
+  const size_t kMax = 40;
+  std::string s(begin, std::min<size_t>(end - begin, kMax));
+  if (static_cast<size_t>(end - begin) > kMax)
+    s += "...";
+  return s;
+}
+
+[[noreturn]] void out_of_range(const char* begin, const char* end,
+                               int attno) {
+  throw std::runtime_error("value out of range in CSV row \"" +
+                           excerpt(begin, end) + "\", field " +
+                           std::to_string(attno + 1));
+}
+
+// Parses one line of CSV into the next row of batch.
+void parse_line(const char* begin, const char* end, const Schema& schema,
+                char delimiter, ColumnBatch& batch) {
+  const char* p = begin;
+  int natts = schema.natts();
+  for (int attno = 0; attno < natts; attno++) {
+    while (p < end && (*p == ' ' || *p == '\t'))
+      p++;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+      negative = *p++ == '-';
+    if (p == end || *p < '0' || *p > '9')
+      throw std::runtime_error("malformed CSV row \"" + excerpt(begin, end) +
+                               "\": expected an integer in field " +
+                               std::to_string(attno + 1));
+
+    // Accumulate as a negative number so that INT64_MIN parses, and stop
+    // before the multiply that would overflow.
+    int64_t v = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+      int digit = *p - '0';
+      if (v < (std::numeric_limits<int64_t>::min() + digit) / 10)
+        out_of_range(begin, end, attno);
+      v = v * 10 - digit;
+    }
+    if (!negative) {
+      if (v == std::numeric_limits<int64_t>::min())
+        out_of_range(begin, end, attno);
+      v = -v;
+    }
+    if (schema.attlen(attno) == sizeof(int32_t) &&
+        (v < std::numeric_limits<int32_t>::min() ||
+         v > std::numeric_limits<int32_t>::max()))
+      out_of_range(begin, end, attno);
+    batch.columns[attno].push_back(v);
+
+    while (p < end && (*p == ' ' || *p == '\t'))
+      p++;
+    if (attno + 1 < natts) {
+      if (p == end || *p != delimiter)
+        throw std::runtime_error("CSV row \"" + excerpt(begin, end) +
+                                 "\" has " + std::to_string(attno + 1) +
+                                 " fields, expected " + std::to_string(natts));
+      p++;
+    }
+  }
+  if (p != end)
+    throw std::runtime_error("CSV row \"" + excerpt(begin, end) +
+                             "\" has more than " + std::to_string(natts) +
+                             " fields");
+  batch.nrows++;
+}
+
+void parse_csv_slice(const char* begin, const char* end, const Schema& schema,
+                     char delimiter, ColumnBatch& batch) {
+  while (begin < end) {
+    const char* eol =
+        static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+    if (eol == nullptr)
+      eol = end;
+    const char* line_end = eol;
+    if (line_end > begin && line_end[-1] == '\r')
+      line_end--;
+    if (line_end > begin)
+      parse_line(begin, line_end, schema, delimiter, batch);
+    begin = eol + 1;
+  }
+}
+
+}  // namespace
+
+uint64_t load_csv(std::FILE* in, BulkLoader& loader,
+                  const InputOptions& opts) {
+  const Schema& schema = loader.schema();
+  WorkerPool& pool = loader.pool();
+  const size_t nslices = pool.size() * kSlicesPerWorker;
+
+  std::vector<char> buf(opts.segment_bytes);
+  size_t carry = 0;  // bytes of an unfinished line kept from the last read
+  uint64_t consumed = 0;
+  bool skip_header = opts.header;
+  bool eof = false;
+
+  while (!eof) {
+    if (carry == buf.size())
+      buf.resize(buf.size() * 2);  // a single line longer than a segment
+    size_t got = read_fully(in, reinterpret_cast<unsigned char*>(buf.data()) +
+                                    carry,
+                            buf.size() - carry);
+    eof = got < buf.size() - carry;
+    consumed += got;
+    size_t len = carry + got;
+
+    // Only whole lines are parsed; the tail waits for the next read.
+    size_t cut = len;
+    if (!eof) {
+      const char* nl = static_cast<const char*>(
+          memrchr(buf.data(), '\n', len));
+      cut = nl == nullptr ? 0 : static_cast<size_t>(nl - buf.data()) + 1;
+    }
+
+    size_t start = 0;
+    if (skip_header && cut > 0) {
+      const char* nl =
+          static_cast<const char*>(std::memchr(buf.data(), '\n', cut));
+      start = nl == nullptr ? cut : static_cast<size_t>(nl - buf.data()) + 1;
+      skip_header = false;
+    }
+
+    // Slice [start, cut) at line boundaries.
+    std::vector<size_t> bounds = {start};
+    for (size_t i = 1; i < nslices; i++) {
+      size_t target = start + (cut - start) * i / nslices;
+      if (target <= bounds.back())
+        continue;
+      const char* nl = static_cast<const char*>(
+          std::memchr(buf.data() + target, '\n', cut - target));
+      size_t b = nl == nullptr ? cut : static_cast<size_t>(nl - buf.data()) + 1;
+      if (b > bounds.back() && b < cut)
+        bounds.push_back(b);
+    }
+    bounds.push_back(cut);
+
+    std::vector<ColumnBatch> batches(bounds.size() - 1, empty_batch(schema));
+    pool.parallel_for(batches.size(), [&](size_t i) {
+      parse_csv_slice(buf.data() + bounds[i], buf.data() + bounds[i + 1],
+                      schema, opts.delimiter, batches[i]);
+    });
+    loader.add(batches);
+
+    carry = len - cut;
+    std::memmove(buf.data(), buf.data() + cut, carry);
+  }
+  return consumed;
+}
+
+uint64_t load_binary(std::FILE* in, BulkLoader& loader,
+                     const InputOptions& opts) {
+  const Schema& schema = loader.schema();
+  WorkerPool& pool = loader.pool();
+  const size_t width = schema.row_width();
+  const size_t segment_rows = std::max<size_t>(1, opts.segment_bytes / width);
+  const size_t nslices = pool.size() * kSlicesPerWorker;
+
+  std::vector<unsigned char> buf(segment_rows * width);
+  uint64_t consumed = 0;
+
+  for (;;) {
+    size_t got = read_fully(in, buf.data(), buf.size());
+    consumed += got;
+    if (got % width != 0)
+      throw std::runtime_error("binary input ends in the middle of a row");
+    size_t nrows = got / width;
+    if (nrows == 0)
+      break;
+
+    size_t per_slice = (nrows + nslices - 1) / nslices;
+    std::vector<ColumnBatch> batches((nrows + per_slice - 1) / per_slice,
+                                     empty_batch(schema));
+    pool.parallel_for(batches.size(), [&](size_t i) {
+      size_t first = i * per_slice;
+      size_t n = std::min(per_slice, nrows - first);
+      ColumnBatch& batch = batches[i];
+      batch.nrows = n;
+      for (int attno = 0; attno < schema.natts(); attno++) {
+        std::vector<int64_t>& out = batch.columns[attno];
+        out.resize(n);
+        const unsigned char* src = buf.data() + first * width +
+                                   schema.offset(attno);
+        if (schema.attlen(attno) == sizeof(int64_t)) {
+          for (size_t r = 0; r < n; r++, src += width)
+            std::memcpy(&out[r], src, sizeof(int64_t));
+        } else {
+          for (size_t r = 0; r < n; r++, src += width) {
+            int32_t v;
+            std::memcpy(&v, src, sizeof(v));
+            out[r] = v;
+          }
+        }
+      }
+    });
+    loader.add(batches);
+
+    if (got < buf.size())
+      break;
+  }
+  return consumed;
+}
+
+}  // namespace zs
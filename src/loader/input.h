@@ -0,0 +1,36 @@
+/*
+ * input.h
+ *	  Input formats for the bulk loader.
+ *
+ * Both readers pull the input in large segments on the calling thread and
+ * parse each segment in parallel on the loader's worker pool, one slice per
+ * task, before handing the slices to BulkLoader::add() in order.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#include "loader/bulk_loader.h"
+
+namespace zs {
+
+struct InputOptions {
+  size_t segment_bytes = 64 << 20;  // input consumed per load step
+  bool header = false;              // CSV: skip the first line
+  char delimiter = ',';             // CSV field separator
+};
+
+// Reads one row per line of delimited decimal integers.  Blank lines are
+// skipped.  Throws std::runtime_error on malformed input.  Returns the
+// number of input bytes consumed.
+uint64_t load_csv(std::FILE* in, BulkLoader& loader,
+                  const InputOptions& opts = InputOptions());
+
+// Reads rows in Schema row format: attributes packed back to back in
+// native byte order.  Throws std::runtime_error if the input ends in the
+// middle of a row.  Returns the number of input bytes consumed.
+uint64_t load_binary(std::FILE* in, BulkLoader& loader,
+                     const InputOptions& opts = InputOptions());
+
+}  // namespace zs
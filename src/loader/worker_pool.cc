@@ -0,0 +1,99 @@
+/*
+ * worker_pool.cc
+ *	  Fixed set of threads running fork-join parallel loops.
+ */
+#include "loader/worker_pool.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace zs {
+
+WorkerPool::WorkerPool(int nworkers) {
+  if (nworkers < 1)
+    throw std::invalid_argument("invalid number of workers: " +
+                                std::to_string(nworkers));
+  for (int i = 1; i < nworkers; i++)
+    threads_.emplace_back([this] { worker_main(); });
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  start_cv_.notify_all();
+  for (auto& t : threads_)
+    t.join();
+}
+
+/*
+ * Claims tasks one at a time until none are left.  Tasks are coarse (a
+ * column of a segment, or a slice of input), so a mutex is cheap enough.
+ */
+void WorkerPool::run_tasks() {
+  for (;;) {
+    size_t task;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (next_task_ >= ntasks_)
+        return;
+      task = next_task_++;
+    }
+    try {
+      (*fn_)(task);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_)
+        error_ = std::current_exception();
+      next_task_ = ntasks_;
+    }
+  }
+}
+
+void WorkerPool::worker_main() {
+  uint64_t seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_cv_.wait(lock, [&] { return shutdown_ || generation_ != seen; });
+      if (shutdown_)
+        return;
+      seen = generation_;
+    }
+    run_tasks();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--running_ == 0)
+        done_cv_.notify_one();
+    }
+  }
+}
+
+void WorkerPool::parallel_for(size_t ntasks,
+                              const std::function<void(size_t)>& fn) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fn_ = &fn;
+    ntasks_ = ntasks;
+    next_task_ = 0;
+    error_ = nullptr;
+    running_ = static_cast<int>(threads_.size());
+    generation_++;
+  }
+  start_cv_.notify_all();
+
+  run_tasks();
+
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [&] { return running_ == 0; });
+    fn_ = nullptr;
+    error = error_;
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+}  // namespace zs
@@ -0,0 +1,53 @@
+/*
+ * worker_pool.h
+ *	  Fixed set of threads running fork-join parallel loops.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace zs {
+
+class WorkerPool {
+ public:
+  // nworkers threads in total; the calling thread counts as one of them.
+  explicit WorkerPool(int nworkers);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  // Calls fn(i) for every i in [0, ntasks), spread over the workers, and
+  // returns when all calls have finished.  If any call throws, the first
+  // exception is rethrown here once the loop has drained.
+  void parallel_for(size_t ntasks, const std::function<void(size_t)>& fn);
+
+  int size() const { return static_cast<int>(threads_.size()) + 1; }
+
+ private:
+  void worker_main();
+  void run_tasks();
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  uint64_t generation_ = 0;
+  bool shutdown_ = false;
+  int running_ = 0;
+
+  // The current loop; only valid while a parallel_for() is in progress.
+  const std::function<void(size_t)>* fn_ = nullptr;
+  size_t ntasks_ = 0;
+  size_t next_task_ = 0;
+  std::exception_ptr error_;
+};
+
+}  // namespace zs
@@ -0,0 +1,68 @@
+/*
+ * segment_format.h
+ *	  On-disk layout of a zone-mapped column segment.
+ *
+ * A segment stores a table of nullable int64 columns, cut into row groups
+ * of rows_per_page rows.  Each column of each row group is one page: a
+ * variable-length byte range holding a SegmentPageHeader, a null bitmap if
+ * the page has nulls, and then the non-null values, zs_codec encoded (or
+ * raw, if encoding would not make them smaller).
+ *
+ *	 [SegmentFileHeader] [page] [page] ... [ZoneEntry x npages] [SegmentFooter]
+ *
+ * Pages are laid out row group by row group, and the zone directory holds
+ * one ZoneEntry per page in the same order, so the entry for (group, attno)
+ * is at group * natts + attno.  A reader loads the footer and directory
+ * once; deciding whether a page can be skipped never touches the page.
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace zs {
+
+constexpr uint32_t kSegmentMagic = 0x5A534547;  // "ZSEG"
+constexpr uint16_t kSegmentVersion = 1;
+
+struct SegmentFileHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t reserved;
+};
+
+// Per-page summary.  min and max cover the non-null values only and are
+// zero when every value is null.
+struct ZoneEntry {
+  int64_t min;
+  int64_t max;
+  uint64_t offset;  // of the page, from the start of the file
+  uint32_t length;  // of the page in bytes
+  uint32_t nvalues;
+  uint32_t null_count;
+  uint32_t pad;
+};
+static_assert(sizeof(ZoneEntry) == 40, "ZoneEntry must stay 40 bytes");
+
+// SegmentPageHeader.flags
+constexpr uint32_t kPageHasNulls = 0x0001;  // null bitmap follows the header
+constexpr uint32_t kPageRaw = 0x0002;       // values stored as plain int64
+
+struct SegmentPageHeader {
+  uint32_t nvalues;     // rows in the page, including nulls
+  uint32_t null_count;
+  uint32_t flags;
+  uint32_t payload;     // bytes of value data after the bitmap
+};
+
+struct SegmentFooter {
+  uint64_t directory_offset;
+  uint64_t nrows;
+  uint32_t ngroups;
+  uint32_t rows_per_page;
+  uint16_t natts;
+  uint16_t version;
+  uint32_t magic;
+};
+static_assert(sizeof(SegmentFooter) == 32, "SegmentFooter must stay 32 bytes");
+
+}  // namespace zs
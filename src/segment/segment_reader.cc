@@ -0,0 +1,139 @@
+/*
+ * segment_reader.cc
+ *	  Opens a zone-mapped column segment and reads individual pages.
+ */
+#include "segment/segment_reader.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "codec/codec.h"
+#include "stats/stats.h"
+#include "storage/errors.h"
+
+namespace zs {
+
+SegmentReader::SegmentReader(const std::string& path) : path_(path) {
+  fd_ = ::open(path.c_str(), O_RDONLY);
+  if (fd_ < 0)
+    throw_errno("could not open \"" + path + "\"");
+
+  try {
+    struct stat st;
+    if (::fstat(fd_, &st) < 0)
+      throw_errno("could not stat \"" + path + "\"");
+    uint64_t size = static_cast<uint64_t>(st.st_size);
+    if (size < sizeof(SegmentFileHeader) + sizeof(SegmentFooter))
+      throw std::runtime_error("\"" + path + "\" is not a column segment");
+
+    pread_fully(&footer_, sizeof(footer_), size - sizeof(footer_));
+    if (footer_.magic != kSegmentMagic || footer_.version != kSegmentVersion)
+      throw std::runtime_error("\"" + path + "\" is not a column segment");
+
+    uint64_t npages = static_cast<uint64_t>(footer_.ngroups) * footer_.natts;
+    if (footer_.directory_offset + npages * sizeof(ZoneEntry) +
+            sizeof(footer_) != size)
+      throw std::runtime_error("corrupt zone directory in \"" + path + "\"");
+    directory_.resize(npages);
+    pread_fully(directory_.data(), npages * sizeof(ZoneEntry),
+                footer_.directory_offset);
+  } catch (...) {
+    ::close(fd_);
+    throw;
+  }
+  // The footer and directory are metadata; count only page reads.
+  reset_stats();
+}
+
+SegmentReader::~SegmentReader() {
+  if (fd_ >= 0)
+    ::close(fd_);
+}
+
+void SegmentReader::pread_fully(void* buf, size_t len, uint64_t offset) {
+  unsigned char* p = static_cast<unsigned char*>(buf);
+  size_t done = 0;
+  while (done < len) {
+    ssize_t n = ::pread(fd_, p + done, len - done,
+                        static_cast<off_t>(offset + done));
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      throw_errno("could not read \"" + path_ + "\"");
+    }
+    if (n == 0)
+      throw std::runtime_error("unexpected end of file in \"" + path_ + "\"");
+    done += static_cast<size_t>(n);
+  }
+  bytes_read_ += len;
+}
+
+void SegmentReader::drop_os_cache() {
+  (void) ::posix_fadvise(fd_, 0, 0, POSIX_FADV_DONTNEED);
+}
+
+void SegmentReader::read_page(uint32_t group, int attno, DecodedPage* out) {
+  const ZoneEntry& z = zone(group, attno);
+  buf_.resize(z.length);
+  {
+    StatTimer timer(StatHistogram::kPageRead);
+    pread_fully(buf_.data(), z.length, z.offset);
+    timer.add(StatCounter::kPageReads);
+    timer.add(StatCounter::kPageReadBytes, z.length);
+  }
+  pages_read_++;
+
+  SegmentPageHeader h;
+  if (z.length < sizeof(h))
+    throw std::runtime_error("corrupt page in \"" + path_ + "\"");
+  std::memcpy(&h, buf_.data(), sizeof(h));
+  if (h.nvalues != z.nvalues || h.null_count > h.nvalues)
+    throw std::runtime_error("corrupt page in \"" + path_ + "\"");
+  size_t pos = sizeof(h);
+  size_t nonnull = h.nvalues - h.null_count;
+
+  out->nvalues = h.nvalues;
+  out->null_count = h.null_count;
+  out->values.resize(h.nvalues + kPackBlockValues);
+  out->nulls.clear();
+
+  // Decode the non-null values into the front of the buffer, then spread
+  // them out to their row positions if there are nulls.
+  const unsigned char* bitmap = nullptr;
+  if (h.flags & kPageHasNulls) {
+    bitmap = buf_.data() + pos;
+    pos += (h.nvalues + 7) / 8;
+  }
+  if (pos + h.payload > z.length)
+    throw std::runtime_error("corrupt page in \"" + path_ + "\"");
+
+  if (h.flags & kPageRaw) {
+    if (h.payload != nonnull * sizeof(int64_t))
+      throw std::runtime_error("corrupt page in \"" + path_ + "\"");
+    std::memcpy(out->values.data(), buf_.data() + pos,
+                nonnull * sizeof(int64_t));
+  } else {
+    Decoder decoder(buf_.data() + pos, h.payload);
+    if (decoder.count() != nonnull)
+      throw std::runtime_error("corrupt page in \"" + path_ + "\"");
+    decoder.decode_all(out->values.data());
+  }
+
+  if (bitmap != nullptr) {
+    out->nulls.resize(h.nvalues);
+    size_t src = nonnull;
+    for (size_t r = h.nvalues; r-- > 0;) {
+      bool null = (bitmap[r / 8] >> (r % 8)) & 1;
+      out->nulls[r] = null;
+      if (!null)
+        out->values[r] = out->values[--src];
+    }
+  }
+}
+
+}  // namespace zs
@@ -0,0 +1,66 @@
+/*
+ * segment_reader.h
+ *	  Opens a zone-mapped column segment and reads individual pages.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "segment/segment_format.h"
+
+namespace zs {
+
+// One page, decoded: nvalues rows, with nulls[r] set for NULL rows.  The
+// values of NULL rows are unspecified.
+struct DecodedPage {
+  uint32_t nvalues = 0;
+  uint32_t null_count = 0;
+  std::vector<int64_t> values;
+  std::vector<uint8_t> nulls;  // empty when null_count is 0
+};
+
+class SegmentReader {
+ public:
+  // Reads the footer and zone directory.  Throws std::system_error, or
+  // std::runtime_error if the file is not a valid segment.
+  explicit SegmentReader(const std::string& path);
+  ~SegmentReader();
+
+  SegmentReader(const SegmentReader&) = delete;
+  SegmentReader& operator=(const SegmentReader&) = delete;
+
+  int natts() const { return footer_.natts; }
+  uint64_t nrows() const { return footer_.nrows; }
+  uint32_t ngroups() const { return footer_.ngroups; }
+  uint32_t rows_per_page() const { return footer_.rows_per_page; }
+
+  const ZoneEntry& zone(uint32_t group, int attno) const {
+    return directory_[static_cast<size_t>(group) * footer_.natts + attno];
+  }
+
+  // Reads and decodes the page of attno in group.  Not thread-safe with
+  // respect to the I/O counters.
+  void read_page(uint32_t group, int attno, DecodedPage* out);
+
+  uint64_t bytes_read() const { return bytes_read_; }
+  uint64_t pages_read() const { return pages_read_; }
+  void reset_stats() { bytes_read_ = pages_read_ = 0; }
+
+  // Asks the kernel to drop the file from the page cache.  Best effort.
+  void drop_os_cache();
+
+ private:
+  void pread_fully(void* buf, size_t len, uint64_t offset);
+
+  int fd_ = -1;
+  std::string path_;
+  SegmentFooter footer_;
+  std::vector<ZoneEntry> directory_;
+  std::vector<unsigned char> buf_;
+  uint64_t bytes_read_ = 0;
+  uint64_t pages_read_ = 0;
+};
+
+}  // namespace zs
@@ -0,0 +1,195 @@
+/*
+ * segment_scan.cc
+ *	  Filtered, projected scan over a column segment with zone-map pruning.
+ */
+#include "segment/segment_scan.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace zs {
+
+namespace {
+
+constexpr uint32_t kNoGroup = std::numeric_limits<uint32_t>::max();
+
+}  // namespace
+
+SegmentScan::SegmentScan(SegmentReader& reader, std::vector<int> projection,
+                         std::vector<Predicate> predicates, bool use_zone_maps)
+    : reader_(reader),
+      projection_(std::move(projection)),
+      use_zone_maps_(use_zone_maps),
+      pages_(reader.natts()),
+      page_group_(reader.natts(), kNoGroup) {
+  auto check = [&](int attno) {
+    if (attno < 0 || attno >= reader.natts())
+      throw std::out_of_range("invalid attribute number " +
+                              std::to_string(attno));
+    if (std::find(referenced_.begin(), referenced_.end(), attno) ==
+        referenced_.end())
+      referenced_.push_back(attno);
+  };
+
+  constexpr int64_t kMin = std::numeric_limits<int64_t>::min();
+  constexpr int64_t kMax = std::numeric_limits<int64_t>::max();
+  for (const Predicate& p : predicates) {
+    check(p.attno);
+    Range r{p.attno, kMin, kMax};
+    switch (p.op) {
+      case CompareOp::kEq:
+        r.lo = r.hi = p.value;
+        break;
+      case CompareOp::kLt:
+        if (p.value == kMin)
+          r = Range{p.attno, kMax, kMin};
+        else
+          r.hi = p.value - 1;
+        break;
+      case CompareOp::kLe:
+        r.hi = p.value;
+        break;
+      case CompareOp::kGt:
+        if (p.value == kMax)
+          r = Range{p.attno, kMax, kMin};
+        else
+          r.lo = p.value + 1;
+        break;
+      case CompareOp::kGe:
+        r.lo = p.value;
+        break;
+      case CompareOp::kBetween:
+        r.lo = p.value;
+        r.hi = p.high;
+        break;
+    }
+    ranges_.push_back(r);
+  }
+  for (int attno : projection_)
+    check(attno);
+}
+
+const DecodedPage& SegmentScan::page(uint32_t group, int attno) {
+  if (page_group_[attno] != group) {
+    reader_.read_page(group, attno, &pages_[attno]);
+    page_group_[attno] = group;
+    stats_.pages_read++;
+  }
+  return pages_[attno];
+}
+
+// Keeps the selected rows of page that fall in range.
+void SegmentScan::filter(const Range& range, const DecodedPage& page) {
+  const int64_t* values = page.values.data();
+  size_t out = 0;
+  if (page.null_count == 0) {
+    for (uint32_t r : selection_) {
+      int64_t v = values[r];
+      selection_[out] = r;
+      out += v >= range.lo && v <= range.hi;
+    }
+  } else {
+    const uint8_t* nulls = page.nulls.data();
+    for (uint32_t r : selection_) {
+      int64_t v = values[r];
+      selection_[out] = r;
+      out += !nulls[r] && v >= range.lo && v <= range.hi;
+    }
+  }
+  selection_.resize(out);
+}
+
+bool SegmentScan::next(SegmentBatch& batch) {
+  size_t ncols = projection_.size();
+  batch.nrows = 0;
+  batch.row_ids.clear();
+  batch.columns.resize(ncols);
+  batch.nulls.resize(ncols);
+
+  while (group_ < reader_.ngroups()) {
+    uint32_t group = group_++;
+    stats_.groups_total++;
+    stats_.pages_total += referenced_.size();
+    uint64_t pages_before = stats_.pages_read;
+
+    // Zone maps first: they can rule the group out or make a predicate
+    // trivially true for it.
+    std::vector<const Range*> to_check;
+    bool skip = false;
+    for (const Range& range : ranges_) {
+      if (!use_zone_maps_) {
+        to_check.push_back(&range);
+        continue;
+      }
+      const ZoneEntry& z = reader_.zone(group, range.attno);
+      if (range.lo > range.hi || z.null_count == z.nvalues ||
+          z.max < range.lo || z.min > range.hi) {
+        skip = true;
+        break;
+      }
+      if (!(z.null_count == 0 && z.min >= range.lo && z.max <= range.hi))
+        to_check.push_back(&range);
+    }
+    if (skip) {
+      stats_.groups_skipped++;
+      stats_.pages_skipped += referenced_.size();
+      continue;
+    }
+
+    uint32_t nrows = reader_.zone(group, 0).nvalues;
+    selection_.resize(nrows);
+    for (uint32_t r = 0; r < nrows; r++)
+      selection_[r] = r;
+    for (const Range* range : to_check) {
+      filter(*range, page(group, range->attno));
+      if (selection_.empty())
+        break;
+    }
+
+    if (!selection_.empty()) {
+      uint64_t first_row = static_cast<uint64_t>(group) *
+                           reader_.rows_per_page();
+      batch.nrows = selection_.size();
+      batch.row_ids.resize(batch.nrows);
+      for (size_t i = 0; i < batch.nrows; i++)
+        batch.row_ids[i] = first_row + selection_[i];
+
+      for (size_t c = 0; c < ncols; c++) {
+        const DecodedPage& p = page(group, projection_[c]);
+        std::vector<int64_t>& out = batch.columns[c];
+        std::vector<uint8_t>& nulls = batch.nulls[c];
+        out.resize(batch.nrows);
+        nulls.assign(batch.nrows, 0);
+        for (size_t i = 0; i < batch.nrows; i++)
+          out[i] = p.values[selection_[i]];
+        if (p.null_count > 0)
+          for (size_t i = 0; i < batch.nrows; i++)
+            nulls[i] = p.nulls[selection_[i]];
+      }
+    }
+
+    // Referenced pages that neither filtering nor projection needed were
+    // ruled out by zone maps; needed pages left unread were spared only
+    // because no row survived the filters, which happens without zone maps
+    // too.
+    size_t needed = 0;
+    for (int attno : referenced_) {
+      bool used = std::find(projection_.begin(), projection_.end(), attno) !=
+                  projection_.end();
+      for (const Range* range : to_check)
+        used = used || range->attno == attno;
+      needed += used;
+    }
+    stats_.pages_skipped += referenced_.size() - needed;
+    stats_.pages_skipped_late += needed - (stats_.pages_read - pages_before);
+    if (batch.nrows > 0) {
+      stats_.rows_matched += batch.nrows;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace zs
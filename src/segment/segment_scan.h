@@ -0,0 +1,96 @@
+/*
+ * segment_scan.h
+ *	  Filtered, projected scan over a column segment with zone-map pruning.
+ *
+ * Predicates are ANDed ranges on int64 columns.  Before reading anything
+ * for a row group, the scan compares every predicate with the zone entry
+ * of its column's page; if any page's [min, max] misses the predicate's
+ * range, or the page is all NULL, the whole row group is skipped without
+ * reading or decompressing a byte of it.  A page whose range lies entirely
+ * inside the predicate and has no NULLs satisfies that predicate for every
+ * row, so it is not read for filtering either.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "segment/segment_reader.h"
+
+namespace zs {
+
+enum class CompareOp {
+  kEq,
+  kLt,
+  kLe,
+  kGt,
+  kGe,
+  kBetween,  // value <= x <= high
+};
+
+// attno op value.  NULL never satisfies a predicate.
+struct Predicate {
+  int attno;
+  CompareOp op;
+  int64_t value;
+  int64_t high = 0;
+};
+
+// One row group's qualifying rows.  columns[i] and nulls[i] belong to the
+// i'th projected attribute; nulls[i][r] is nonzero for NULL.
+struct SegmentBatch {
+  size_t nrows = 0;
+  std::vector<uint64_t> row_ids;
+  std::vector<std::vector<int64_t>> columns;
+  std::vector<std::vector<uint8_t>> nulls;
+};
+
+struct SegmentScanStats {
+  uint64_t groups_total = 0;
+  uint64_t groups_skipped = 0;      // pruned by zone maps alone
+  uint64_t pages_total = 0;         // groups x distinct columns referenced
+  uint64_t pages_skipped = 0;       // never read, thanks to zone maps
+  uint64_t pages_skipped_late = 0;  // never read, as no row qualified
+  uint64_t pages_read = 0;
+  uint64_t rows_matched = 0;
+};
+
+class SegmentScan {
+ public:
+  // use_zone_maps = false evaluates every predicate on every row, for
+  // comparison; pages_skipped then stays 0.  Throws std::out_of_range for a
+  // bad attribute number.
+  SegmentScan(SegmentReader& reader, std::vector<int> projection,
+              std::vector<Predicate> predicates, bool use_zone_maps = true);
+
+  // Fills batch with the qualifying rows of the next row group that has
+  // any.  Returns false at the end of the segment.
+  bool next(SegmentBatch& batch);
+
+  const SegmentScanStats& stats() const { return stats_; }
+
+ private:
+  // A predicate normalized to an inclusive range; lo > hi matches nothing.
+  struct Range {
+    int attno;
+    int64_t lo;
+    int64_t hi;
+  };
+
+  const DecodedPage& page(uint32_t group, int attno);
+  void filter(const Range& range, const DecodedPage& page);
+
+  SegmentReader& reader_;
+  std::vector<int> projection_;
+  std::vector<Range> ranges_;
+  bool use_zone_maps_;
+  uint32_t group_ = 0;
+  SegmentScanStats stats_;
+
+  std::vector<int> referenced_;       // distinct attributes touched
+  std::vector<DecodedPage> pages_;    // per attno, for the current group
+  std::vector<uint32_t> page_group_;  // group pages_[attno] belongs to
+  std::vector<uint32_t> selection_;   // surviving row offsets in the group
+};
+
+}  // namespace zs
@@ -0,0 +1,151 @@
+/*
+ * segment_writer.cc
+ *	  Writes a zone-mapped column segment.
+ */
+#include "segment/segment_writer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "codec/codec.h"
+#include "storage/errors.h"
+
+namespace zs {
+
+SegmentWriter::SegmentWriter(const std::string& path, int natts,
+                             uint32_t rows_per_page)
+    : path_(path), natts_(natts), rows_per_page_(rows_per_page) {
+  if (natts <= 0 || natts > std::numeric_limits<uint16_t>::max())
+    throw std::invalid_argument("invalid number of columns: " +
+                                std::to_string(natts));
+  if (rows_per_page == 0)
+    throw std::invalid_argument("rows_per_page must be positive");
+
+  file_ = std::fopen(path.c_str(), "wb");
+  if (file_ == nullptr)
+    throw_errno("could not create \"" + path + "\"");
+
+  values_.resize(natts);
+  nulls_.resize(natts);
+  for (int i = 0; i < natts; i++) {
+    values_[i].reserve(rows_per_page);
+    nulls_[i].reserve(rows_per_page);
+  }
+
+  SegmentFileHeader header{kSegmentMagic, kSegmentVersion, 0};
+  write(&header, sizeof(header));
+}
+
+SegmentWriter::~SegmentWriter() {
+  if (file_ != nullptr)
+    std::fclose(file_);
+}
+
+void SegmentWriter::write(const void* data, size_t len) {
+  if (std::fwrite(data, 1, len, file_) != len)
+    throw_errno("could not write to \"" + path_ + "\"");
+  offset_ += len;
+}
+
+void SegmentWriter::append(const int64_t* values, const uint8_t* isnull) {
+  if (finished_)
+    throw std::logic_error("SegmentWriter::append() after finish()");
+  for (int i = 0; i < natts_; i++) {
+    bool null = isnull != nullptr && isnull[i];
+    nulls_[i].push_back(null);
+    if (!null)
+      values_[i].push_back(values[i]);
+  }
+  nrows_++;
+  if (++group_rows_ == rows_per_page_)
+    flush_group();
+}
+
+void SegmentWriter::write_page(int attno) {
+  const std::vector<int64_t>& values = values_[attno];
+  const std::vector<uint8_t>& nulls = nulls_[attno];
+
+  ZoneEntry zone{};
+  zone.offset = offset_;
+  zone.nvalues = group_rows_;
+  zone.null_count = static_cast<uint32_t>(group_rows_ - values.size());
+  if (!values.empty()) {
+    auto [lo, hi] = std::minmax_element(values.begin(), values.end());
+    zone.min = *lo;
+    zone.max = *hi;
+  }
+
+  SegmentPageHeader h{};
+  h.nvalues = group_rows_;
+  h.null_count = zone.null_count;
+
+  page_.assign(sizeof(h), 0);
+  if (h.null_count > 0) {
+    h.flags |= kPageHasNulls;
+    size_t bitmap = page_.size();
+    page_.resize(bitmap + (group_rows_ + 7) / 8, 0);
+    for (uint32_t r = 0; r < group_rows_; r++)
+      if (nulls[r])
+        page_[bitmap + r / 8] |= static_cast<unsigned char>(1u << (r % 8));
+  }
+
+  size_t payload = page_.size();
+  Codec codec = choose_codec(values.data(), values.size());
+  if (encoded_size(codec, values.data(), values.size()) <
+      values.size() * sizeof(int64_t)) {
+    encode(codec, values.data(), values.size(), page_);
+  } else {
+    h.flags |= kPageRaw;
+    page_.resize(payload + values.size() * sizeof(int64_t));
+    std::memcpy(page_.data() + payload, values.data(),
+                values.size() * sizeof(int64_t));
+  }
+  h.payload = static_cast<uint32_t>(page_.size() - payload);
+  std::memcpy(page_.data(), &h, sizeof(h));
+
+  zone.length = static_cast<uint32_t>(page_.size());
+  write(page_.data(), page_.size());
+  directory_.push_back(zone);
+}
+
+void SegmentWriter::flush_group() {
+  if (group_rows_ == 0)
+    return;
+  for (int i = 0; i < natts_; i++)
+    write_page(i);
+  for (int i = 0; i < natts_; i++) {
+    values_[i].clear();
+    nulls_[i].clear();
+  }
+  group_rows_ = 0;
+  ngroups_++;
+}
+
+void SegmentWriter::finish() {
+  if (finished_)
+    return;
+  flush_group();
+  finished_ = true;
+
+  SegmentFooter footer{};
+  footer.directory_offset = offset_;
+  footer.nrows = nrows_;
+  footer.ngroups = ngroups_;
+  footer.rows_per_page = rows_per_page_;
+  footer.natts = static_cast<uint16_t>(natts_);
+  footer.version = kSegmentVersion;
+  footer.magic = kSegmentMagic;
+
+  write(directory_.data(), directory_.size() * sizeof(ZoneEntry));
+  write(&footer, sizeof(footer));
+
+  if (std::fclose(file_) != 0) {
+    file_ = nullptr;
+    throw_errno("could not close \"" + path_ + "\"");
+  }
+  file_ = nullptr;
+}
+
+}  // namespace zs
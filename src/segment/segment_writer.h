@@ -0,0 +1,60 @@
+/*
+ * segment_writer.h
+ *	  Writes a zone-mapped column segment.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "segment/segment_format.h"
+
+namespace zs {
+
+constexpr uint32_t kDefaultRowsPerPage = 4096;
+
+class SegmentWriter {
+ public:
+  // Creates (truncating) path.  Throws std::system_error.
+  SegmentWriter(const std::string& path, int natts,
+                uint32_t rows_per_page = kDefaultRowsPerPage);
+  ~SegmentWriter();
+
+  SegmentWriter(const SegmentWriter&) = delete;
+  SegmentWriter& operator=(const SegmentWriter&) = delete;
+
+  // Appends one row of natts values.  isnull may be null if the row has no
+  // nulls; otherwise a nonzero isnull[i] makes values[i] NULL.
+  void append(const int64_t* values, const uint8_t* isnull = nullptr);
+
+  // Writes the last row group, the zone directory and the footer.
+  void finish();
+
+  uint64_t bytes_written() const { return offset_; }
+
+ private:
+  void flush_group();
+  void write_page(int attno);
+  void write(const void* data, size_t len);
+
+  std::FILE* file_;
+  std::string path_;
+  int natts_;
+  uint32_t rows_per_page_;
+  uint64_t offset_ = 0;
+  uint64_t nrows_ = 0;
+  uint32_t ngroups_ = 0;
+  bool finished_ = false;
+
+  // The row group being filled, column by column.
+  uint32_t group_rows_ = 0;
+  std::vector<std::vector<int64_t>> values_;
+  std::vector<std::vector<uint8_t>> nulls_;
+
+  std::vector<ZoneEntry> directory_;
+  std::vector<unsigned char> page_;
+};
+
+}  // namespace zs
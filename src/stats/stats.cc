@@ -0,0 +1,263 @@
+/*
+ * stats.cc
+ *	  Thread registry, snapshots and JSON output for the instrumentation
+ *	  counters.
+ */
+#include "stats/stats.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+namespace zs {
+
+std::atomic<bool> g_stats_enabled{true};
+std::atomic<uint32_t> g_stats_sample_interval[kNumStatHistograms] = {
+    {16},    // kPageRead
+    {64},    // kDecodeBatch
+    {4096},  // kBTreeDescent
+};
+__thread ThreadStats* t_thread_stats = nullptr;
+
+namespace {
+
+const char* const kCounterNames[kNumStatCounters] = {
+    "page_reads",     "page_read_bytes", "cache_hits",
+    "cache_misses",   "decode_batches",  "decode_values",
+    "btree_descents", "btree_descent_pages",
+};
+
+const char* const kHistogramNames[kNumStatHistograms] = {
+    "page_read_ns",
+    "decode_batch_ns",
+    "btree_descent_ns",
+};
+
+// Raw totals, before the reset baseline is taken off.
+struct Totals {
+  uint64_t counters[kNumStatCounters] = {};
+  struct {
+    uint64_t samples = 0;
+    uint64_t sum = 0;
+    uint64_t buckets[kHistBuckets] = {};
+  } histograms[kNumStatHistograms];
+
+  void add(const ThreadStats& s) {
+    for (size_t c = 0; c < kNumStatCounters; c++)
+      counters[c] += s.counters[c].load(std::memory_order_relaxed);
+    for (size_t h = 0; h < kNumStatHistograms; h++) {
+      const ThreadStats::Histogram& src = s.histograms[h];
+      histograms[h].samples += src.samples.load(std::memory_order_relaxed);
+      histograms[h].sum += src.sum.load(std::memory_order_relaxed);
+      for (size_t b = 0; b < kHistBuckets; b++)
+        histograms[h].buckets[b] +=
+            src.buckets[b].load(std::memory_order_relaxed);
+    }
+  }
+};
+
+struct Registry {
+  std::mutex mutex;
+  std::vector<ThreadStats*> live;
+  std::unique_ptr<Totals> exited = std::make_unique<Totals>();
+  std::unique_ptr<Totals> baseline = std::make_unique<Totals>();
+  uint32_t threads = 0;
+};
+
+// Never destroyed, so that threads exiting during static destruction can
+// still fold their counts in.
+Registry& registry() {
+  static Registry* r = new Registry;
+  return *r;
+}
+
+void collect(Registry& r, Totals* out) {
+  *out = *r.exited;
+  for (const ThreadStats* s : r.live)
+    out->add(*s);
+}
+
+// Folds the thread's block into the exited totals when the thread ends.
+struct ThreadExit {
+  ThreadStats* stats = nullptr;
+
+  ~ThreadExit() {
+    if (stats == nullptr)
+      return;
+    Registry& r = registry();
+    {
+      std::lock_guard<std::mutex> lock(r.mutex);
+      r.exited->add(*stats);
+      for (size_t i = 0; i < r.live.size(); i++)
+        if (r.live[i] == stats) {
+          r.live[i] = r.live.back();
+          r.live.pop_back();
+          break;
+        }
+    }
+    t_thread_stats = nullptr;
+    delete stats;
+  }
+};
+
+}  // namespace
+
+ThreadStats* stats_register_thread() {
+  static thread_local ThreadExit exit;
+  ThreadStats* s = new ThreadStats();
+  Registry& r = registry();
+  {
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.live.push_back(s);
+    r.threads++;
+  }
+  exit.stats = s;
+  t_thread_stats = s;
+  return s;
+}
+
+uint64_t hist_bucket_low(size_t b) {
+  if (b < kHistSubBuckets)
+    return b;
+  int shift = static_cast<int>(b / kHistSubBuckets) - 1;
+  return (kHistSubBuckets + b % kHistSubBuckets) << shift;
+}
+
+uint64_t hist_bucket_high(size_t b) {
+  if (b < kHistSubBuckets)
+    return b;
+  int shift = static_cast<int>(b / kHistSubBuckets) - 1;
+  return hist_bucket_low(b) + ((uint64_t(1) << shift) - 1);
+}
+
+double HistogramSnapshot::mean() const {
+  return samples == 0 ? 0.0 : static_cast<double>(sum) / samples;
+}
+
+uint64_t HistogramSnapshot::min() const {
+  for (size_t b = 0; b < kHistBuckets; b++)
+    if (buckets[b] != 0)
+      return hist_bucket_low(b);
+  return 0;
+}
+
+uint64_t HistogramSnapshot::max() const {
+  for (size_t b = kHistBuckets; b-- > 0;)
+    if (buckets[b] != 0)
+      return hist_bucket_high(b);
+  return 0;
+}
+
+uint64_t HistogramSnapshot::percentile(double p) const {
+  if (samples == 0)
+    return 0;
+  // Rank of the sample wanted, 1-based; rounding up keeps p = 100 on the
+  // last sample and p = 0 on the first.
+  double want = p / 100.0 * static_cast<double>(samples);
+  uint64_t rank = want < 1.0 ? 1 : static_cast<uint64_t>(want + 0.999999);
+  uint64_t seen = 0;
+  for (size_t b = 0; b < kHistBuckets; b++) {
+    seen += buckets[b];
+    if (seen >= rank)
+      return hist_bucket_high(b);
+  }
+  return max();
+}
+
+const char* stat_counter_name(StatCounter c) {
+  return kCounterNames[static_cast<size_t>(c)];
+}
+
+const char* stat_histogram_name(StatHistogram h) {
+  return kHistogramNames[static_cast<size_t>(h)];
+}
+
+void stats_set_enabled(bool enabled) {
+  g_stats_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void stats_set_sample_interval(StatHistogram h, uint32_t interval) {
+  g_stats_sample_interval[static_cast<size_t>(h)].store(
+      interval == 0 ? 1 : interval, std::memory_order_relaxed);
+}
+
+StatsSnapshot stats_snapshot() {
+  Registry& r = registry();
+  auto raw = std::make_unique<Totals>();
+  StatsSnapshot snap;
+  std::lock_guard<std::mutex> lock(r.mutex);
+  collect(r, raw.get());
+  snap.threads = r.threads;
+
+  // Owners write without synchronizing with us, so a count may be seen
+  // before the reset that should have hidden it; never go below zero.
+  const Totals& base = *r.baseline;
+  auto since = [](uint64_t now, uint64_t then) {
+    return now > then ? now - then : 0;
+  };
+  for (size_t c = 0; c < kNumStatCounters; c++)
+    snap.counters[c] = since(raw->counters[c], base.counters[c]);
+  for (size_t h = 0; h < kNumStatHistograms; h++) {
+    HistogramSnapshot& out = snap.histograms[h];
+    out.samples = since(raw->histograms[h].samples, base.histograms[h].samples);
+    out.sum = since(raw->histograms[h].sum, base.histograms[h].sum);
+    out.sample_interval =
+        g_stats_sample_interval[h].load(std::memory_order_relaxed);
+    for (size_t b = 0; b < kHistBuckets; b++)
+      out.buckets[b] =
+          since(raw->histograms[h].buckets[b], base.histograms[h].buckets[b]);
+  }
+  return snap;
+}
+
+void stats_reset() {
+  // Blocks belong to their threads and cannot be zeroed under them, so a
+  // reset just moves the baseline that snapshots are taken relative to.
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  collect(r, r.baseline.get());
+}
+
+std::string stats_to_json(const StatsSnapshot& snap) {
+  std::string out;
+  char buf[256];
+  auto append = [&](const char* fmt, auto... args) {
+    std::snprintf(buf, sizeof(buf), fmt, args...);
+    out += buf;
+  };
+
+  append("{\"enabled\":%s,\"threads\":%" PRIu32 ",\"counters\":{",
+         stats_enabled() ? "true" : "false", snap.threads);
+  for (size_t c = 0; c < kNumStatCounters; c++)
+    append("%s\"%s\":%" PRIu64, c == 0 ? "" : ",", kCounterNames[c],
+           snap.counters[c]);
+  out += "},\"histograms\":{";
+  for (size_t h = 0; h < kNumStatHistograms; h++) {
+    const HistogramSnapshot& hist = snap.histograms[h];
+    append("%s\"%s\":{\"samples\":%" PRIu64 ",\"sample_interval\":%" PRIu32
+           ",\"sum\":%" PRIu64 ",\"mean\":%.1f",
+           h == 0 ? "" : ",", kHistogramNames[h], hist.samples,
+           hist.sample_interval, hist.sum, hist.mean());
+    append(",\"min\":%" PRIu64 ",\"p50\":%" PRIu64 ",\"p90\":%" PRIu64
+           ",\"p99\":%" PRIu64 ",\"p999\":%" PRIu64 ",\"max\":%" PRIu64,
+           hist.min(), hist.percentile(50), hist.percentile(90),
+           hist.percentile(99), hist.percentile(99.9), hist.max());
+    // Non-empty buckets as [low, high, count], for rebuilding the
+    // distribution elsewhere.
+    out += ",\"buckets\":[";
+    bool first = true;
+    for (size_t b = 0; b < kHistBuckets; b++) {
+      if (hist.buckets[b] == 0)
+        continue;
+      append("%s[%" PRIu64 ",%" PRIu64 ",%" PRIu64 "]", first ? "" : ",",
+             hist_bucket_low(b), hist_bucket_high(b), hist.buckets[b]);
+      first = false;
+    }
+    out += "]}";
+  }
+  out += "}}";
+  return out;
+}
+
+}  // namespace zs
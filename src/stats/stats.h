@@ -0,0 +1,237 @@
+/*
+ * stats.h
+ *	  Hot-path instrumentation: per-thread counters and latency histograms.
+ *
+ * Every thread that records anything gets its own block of counters and
+ * histograms, so recording is a thread-local add with no atomic
+ * read-modify-write and no sharing between cores.  Blocks are only ever
+ * written by their owner; stats_snapshot() sums them with relaxed loads
+ * while they keep running.  When a thread exits its block is folded into a
+ * process-wide total.
+ *
+ * Counters count every event.  Latency histograms are HDR-style: log-linear
+ * buckets with 32 sub-buckets per power of two, so any recorded value is
+ * known to within about 3% over the whole 64-bit range of nanoseconds.
+ * Reading the clock costs more than many of the operations being timed, so
+ * each thread times only one in every sample_interval events per histogram;
+ * the samples are unbiased, and the counters still give exact totals.
+ * Beyond the clock read itself, a timestamp waits for outstanding loads,
+ * which stops the CPU overlapping the cache misses of consecutive B-tree
+ * descents; that is why descents are sampled so sparsely.
+ *
+ * Recording can be switched off at run time with stats_set_enabled(), which
+ * leaves one predictable branch per call site, or compiled out entirely by
+ * configuring with -DZS_STATS=OFF.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace zs {
+
+enum class StatCounter : uint32_t {
+  kPageReads,
+  kPageReadBytes,
+  kCacheHits,
+  kCacheMisses,
+  kDecodeBatches,
+  kDecodeValues,
+  kBTreeDescents,
+  kBTreeDescentPages,  // pages visited by descents, leaf included
+  kCount
+};
+
+enum class StatHistogram : uint32_t {
+  kPageRead,       // one page or segment page read from a file
+  kDecodeBatch,    // one Decoder::next_batch call
+  kBTreeDescent,   // root to leaf
+  kCount
+};
+
+constexpr size_t kNumStatCounters = static_cast<size_t>(StatCounter::kCount);
+constexpr size_t kNumStatHistograms =
+    static_cast<size_t>(StatHistogram::kCount);
+
+// Histogram bucketing: values below kHistSubBuckets get a bucket each; above
+// that every power of two is split into kHistSubBuckets equal buckets.
+constexpr int kHistSubBucketBits = 5;
+constexpr uint64_t kHistSubBuckets = uint64_t(1) << kHistSubBucketBits;
+constexpr size_t kHistBuckets = (64 - kHistSubBucketBits + 1) * kHistSubBuckets;
+
+inline size_t hist_bucket(uint64_t value) {
+  if (value < kHistSubBuckets)
+    return static_cast<size_t>(value);
+  int e = 63 - __builtin_clzll(value);
+  return static_cast<size_t>(e - kHistSubBucketBits + 1) * kHistSubBuckets +
+         ((value >> (e - kHistSubBucketBits)) & (kHistSubBuckets - 1));
+}
+
+// Smallest and largest values that land in bucket b.
+uint64_t hist_bucket_low(size_t b);
+uint64_t hist_bucket_high(size_t b);
+
+// All values in nanoseconds.
+struct HistogramSnapshot {
+  uint64_t samples = 0;
+  uint64_t sum = 0;  // of the sampled values
+  uint32_t sample_interval = 1;
+  std::vector<uint64_t> buckets = std::vector<uint64_t>(kHistBuckets, 0);
+
+  double mean() const;
+  // Bucket bounds, so accurate to the bucket width; 0 when empty.
+  uint64_t min() const;
+  uint64_t max() const;
+  // Value at or below which p percent of samples fall, 0 <= p <= 100.
+  uint64_t percentile(double p) const;
+};
+
+struct StatsSnapshot {
+  uint32_t threads = 0;  // threads that have recorded, live or exited
+  uint64_t counters[kNumStatCounters] = {};
+  HistogramSnapshot histograms[kNumStatHistograms];
+
+  uint64_t counter(StatCounter c) const {
+    return counters[static_cast<size_t>(c)];
+  }
+  const HistogramSnapshot& histogram(StatHistogram h) const {
+    return histograms[static_cast<size_t>(h)];
+  }
+};
+
+const char* stat_counter_name(StatCounter c);
+const char* stat_histogram_name(StatHistogram h);
+
+void stats_set_enabled(bool enabled);
+// Times one in every interval events on each thread; 0 is taken as 1.
+void stats_set_sample_interval(StatHistogram h, uint32_t interval);
+
+// Everything recorded since start-up or the last stats_reset().
+StatsSnapshot stats_snapshot();
+void stats_reset();
+
+std::string stats_to_json(const StatsSnapshot& snapshot);
+
+// What follows is the recording side, inlined into the instrumented code.
+
+struct ThreadStats {
+  struct Histogram {
+    std::atomic<uint64_t> samples{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> buckets[kHistBuckets] = {};
+  };
+
+  std::atomic<uint64_t> counters[kNumStatCounters] = {};
+  Histogram histograms[kNumStatHistograms];
+  uint32_t countdown[kNumStatHistograms] = {};  // owner only
+};
+
+extern std::atomic<bool> g_stats_enabled;
+extern std::atomic<uint32_t> g_stats_sample_interval[kNumStatHistograms];
+// __thread rather than thread_local: the pointer needs no dynamic
+// initialization, and this keeps the compiler from guarding every access
+// with a call to a TLS init function.
+extern __thread ThreadStats* t_thread_stats;
+
+ThreadStats* stats_register_thread();
+
+inline bool stats_enabled() {
+#ifndef ZS_NO_STATS
+  return g_stats_enabled.load(std::memory_order_relaxed);
+#else
+  return false;
+#endif
+}
+
+// Only the owning thread writes, so a plain load and store is enough; the
+// atomics just make the snapshot's concurrent reads well defined.
+inline void stats_bump(std::atomic<uint64_t>& v, uint64_t n) {
+  v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+inline ThreadStats& stats_local() {
+  ThreadStats* s = t_thread_stats;
+  if (__builtin_expect(s == nullptr, 0))
+    s = stats_register_thread();
+  return *s;
+}
+
+inline void stat_add(StatCounter c, uint64_t n = 1) {
+#ifndef ZS_NO_STATS
+  if (stats_enabled())
+    stats_bump(stats_local().counters[static_cast<size_t>(c)], n);
+#else
+  (void) c;
+  (void) n;
+#endif
+}
+
+inline void stats_record_into(ThreadStats& s, StatHistogram h, uint64_t ns) {
+  ThreadStats::Histogram& hist = s.histograms[static_cast<size_t>(h)];
+  stats_bump(hist.samples, 1);
+  stats_bump(hist.sum, ns);
+  stats_bump(hist.buckets[hist_bucket(ns)], 1);
+}
+
+inline void stat_record(StatHistogram h, uint64_t ns) {
+#ifndef ZS_NO_STATS
+  if (stats_enabled())
+    stats_record_into(stats_local(), h, ns);
+#else
+  (void) h;
+  (void) ns;
+#endif
+}
+
+inline uint64_t stats_now_ns() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+// Times the enclosing scope into a histogram, if this event is sampled.
+// Counters for the same event can be bumped through add(), which saves
+// looking up the thread's block again.
+class StatTimer {
+ public:
+  explicit StatTimer(StatHistogram h) : h_(h) {
+#ifndef ZS_NO_STATS
+    if (!stats_enabled())
+      return;
+    stats_ = &stats_local();
+    uint32_t& left = stats_->countdown[static_cast<size_t>(h)];
+    if (left > 1) {
+      left--;
+      return;
+    }
+    left = g_stats_sample_interval[static_cast<size_t>(h)].load(
+        std::memory_order_relaxed);
+    start_ = stats_now_ns();
+#endif
+  }
+  ~StatTimer() {
+    if (start_ != 0)
+      stats_record_into(*stats_, h_, stats_now_ns() - start_);
+  }
+
+  StatTimer(const StatTimer&) = delete;
+  StatTimer& operator=(const StatTimer&) = delete;
+
+  // Like stat_add(), but only if recording was on when the timer started.
+  void add(StatCounter c, uint64_t n = 1) {
+    if (stats_ != nullptr)
+      stats_bump(stats_->counters[static_cast<size_t>(c)], n);
+  }
+
+ private:
+  StatHistogram h_;
+  ThreadStats* stats_ = nullptr;
+  uint64_t start_ = 0;
+};
+
+}  // namespace zs
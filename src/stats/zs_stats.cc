@@ -0,0 +1,129 @@
+/*
+ * zs_stats.cc
+ *	  C wrappers around the instrumentation snapshot API.
+ */
+#include "stats/zs_stats.h"
+
+#include <cstring>
+#include <new>
+
+#include "stats/stats.h"
+
+struct zs_stats_snapshot {
+  zs::StatsSnapshot snap;
+};
+
+namespace {
+
+bool valid_counter(int c) {
+  return c >= 0 && static_cast<size_t>(c) < zs::kNumStatCounters;
+}
+
+bool valid_histogram(int h) {
+  return h >= 0 && static_cast<size_t>(h) < zs::kNumStatHistograms;
+}
+
+const zs::HistogramSnapshot* histogram(const zs_stats_snapshot* snap, int h) {
+  if (snap == nullptr || !valid_histogram(h))
+    return nullptr;
+  return &snap->snap.histograms[h];
+}
+
+}  // namespace
+
+extern "C" {
+
+void zs_stats_set_enabled(int enabled) {
+  zs::stats_set_enabled(enabled != 0);
+}
+
+int zs_stats_enabled(void) {
+  return zs::stats_enabled() ? 1 : 0;
+}
+
+void zs_stats_reset(void) {
+  try {
+    zs::stats_reset();
+  } catch (...) {
+  }
+}
+
+zs_stats_snapshot* zs_stats_snapshot_take(void) {
+  try {
+    return new zs_stats_snapshot{zs::stats_snapshot()};
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void zs_stats_snapshot_free(zs_stats_snapshot* snap) {
+  delete snap;
+}
+
+int zs_stats_counter_count(void) {
+  return static_cast<int>(zs::kNumStatCounters);
+}
+
+const char* zs_stats_counter_name(int counter) {
+  if (!valid_counter(counter))
+    return nullptr;
+  return zs::stat_counter_name(static_cast<zs::StatCounter>(counter));
+}
+
+uint64_t zs_stats_counter_value(const zs_stats_snapshot* snap, int counter) {
+  if (snap == nullptr || !valid_counter(counter))
+    return 0;
+  return snap->snap.counters[counter];
+}
+
+int zs_stats_histogram_count(void) {
+  return static_cast<int>(zs::kNumStatHistograms);
+}
+
+const char* zs_stats_histogram_name(int h) {
+  if (!valid_histogram(h))
+    return nullptr;
+  return zs::stat_histogram_name(static_cast<zs::StatHistogram>(h));
+}
+
+uint64_t zs_stats_histogram_samples(const zs_stats_snapshot* snap, int h) {
+  const zs::HistogramSnapshot* hist = histogram(snap, h);
+  return hist != nullptr ? hist->samples : 0;
+}
+
+double zs_stats_histogram_mean(const zs_stats_snapshot* snap, int h) {
+  const zs::HistogramSnapshot* hist = histogram(snap, h);
+  return hist != nullptr ? hist->mean() : 0.0;
+}
+
+uint64_t zs_stats_histogram_max(const zs_stats_snapshot* snap, int h) {
+  const zs::HistogramSnapshot* hist = histogram(snap, h);
+  return hist != nullptr ? hist->max() : 0;
+}
+
+uint64_t zs_stats_histogram_percentile(const zs_stats_snapshot* snap, int h,
+                                       double percentile) {
+  const zs::HistogramSnapshot* hist = histogram(snap, h);
+  if (hist == nullptr || !(percentile >= 0.0 && percentile <= 100.0))
+    return 0;
+  return hist->percentile(percentile);
+}
+
+size_t zs_stats_snapshot_json(const zs_stats_snapshot* snap, char* buf,
+                              size_t len) {
+  if (snap == nullptr)
+    return 0;
+  try {
+    std::string json = zs::stats_to_json(snap->snap);
+    if (buf != nullptr && len > 0) {
+      size_t n = json.size() < len - 1 ? json.size() : len - 1;
+      std::memcpy(buf, json.data(), n);
+      buf[n] = '\0';
+    }
+    return json.size();
+  } catch (...) {
+    return 0;
+  }
+}
+
+}  // extern "C"
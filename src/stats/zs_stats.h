@@ -0,0 +1,56 @@
+/*
+ * zs_stats.h
+ *	  C interface to the instrumentation counters and histograms, for
+ *	  embedding programs and monitoring agents that are not C++.
+ *
+ * Counters and histograms are addressed by index, 0 up to
+ * zs_stats_counter_count() or zs_stats_histogram_count(); names are stable
+ * and match the keys of the JSON output.  Latencies are in nanoseconds.
+ * None of these functions throw or abort; on failure they return NULL or 0.
+ */
+#ifndef ZS_STATS_H
+#define ZS_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct zs_stats_snapshot zs_stats_snapshot;
+
+void zs_stats_set_enabled(int enabled);
+int zs_stats_enabled(void);
+void zs_stats_reset(void);
+
+zs_stats_snapshot* zs_stats_snapshot_take(void);
+void zs_stats_snapshot_free(zs_stats_snapshot* snap);
+
+int zs_stats_counter_count(void);
+const char* zs_stats_counter_name(int counter);
+uint64_t zs_stats_counter_value(const zs_stats_snapshot* snap, int counter);
+
+int zs_stats_histogram_count(void);
+const char* zs_stats_histogram_name(int histogram);
+uint64_t zs_stats_histogram_samples(const zs_stats_snapshot* snap,
+                                    int histogram);
+double zs_stats_histogram_mean(const zs_stats_snapshot* snap, int histogram);
+uint64_t zs_stats_histogram_max(const zs_stats_snapshot* snap, int histogram);
+/* Value at or below which percentile percent of samples fall. */
+uint64_t zs_stats_histogram_percentile(const zs_stats_snapshot* snap,
+                                       int histogram, double percentile);
+
+/*
+ * Writes the snapshot as JSON, with snprintf conventions: at most len bytes
+ * including the terminating NUL are written, and the return value is the
+ * full length of the JSON text, not counting the NUL.
+ */
+size_t zs_stats_snapshot_json(const zs_stats_snapshot* snap, char* buf,
+                              size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZS_STATS_H */
@@ -0,0 +1,202 @@
+/*
+ * btree.cc
+ *	  TID-keyed B-tree with fixed-size items.
+ */
+#include "storage/btree.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "stats/stats.h"
+
+namespace zs {
+
+namespace {
+
+const InternalItem* downlinks(const Page* page) {
+  return reinterpret_cast<const InternalItem*>(page->items());
+}
+
+InternalItem* downlinks(Page* page) {
+  return reinterpret_cast<InternalItem*>(page->items());
+}
+
+// Index of the downlink to follow for tid: the last one whose key is <= tid.
+uint32_t choose_child(const Page* page, zstid tid) {
+  const InternalItem* items = downlinks(page);
+  uint32_t lo = 0, hi = page->header()->nitems;
+  while (hi - lo > 1) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    if (items[mid].tid <= tid)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+constexpr uint32_t kInternalCapacity = page_capacity(sizeof(InternalItem));
+
+}  // namespace
+
+BTree::BTree(PageStore& store, BlockNumber* root, uint16_t item_size)
+    : store_(store), root_(root), item_size_(item_size) {
+  if (item_size == 0 || page_capacity(item_size) == 0)
+    throw std::invalid_argument("unsupported B-tree item size " +
+                                std::to_string(item_size));
+}
+
+void BTree::append(zstid tid, const void* item) {
+  if (*root_ == kInvalidBlock) {
+    BlockNumber blkno;
+    Page* leaf = store_.allocate(&blkno);
+    leaf->init(kLeafPage, 0, item_size_);
+    leaf->header()->first_tid = tid;
+    leaf->header()->nitems = 1;
+    std::memcpy(leaf->items(), item, item_size_);
+    *root_ = blkno;
+    return;
+  }
+
+  // Descend along the rightmost edge, remembering the path for splits.
+  std::vector<BlockNumber> path;
+  BlockNumber blkno = *root_;
+  Page* page = store_.get(blkno);
+  while (page->header()->kind == kInternalPage) {
+    path.push_back(blkno);
+    blkno = downlinks(page)[page->header()->nitems - 1].child;
+    page = store_.get(blkno);
+  }
+
+  PageHeader* h = page->header();
+  zstid end = h->first_tid + h->nitems;
+  if (tid < end)
+    throw std::logic_error("B-tree append out of TID order");
+
+  if (tid == end && !(h->flags & kLeafCompressed) &&
+      h->nitems < page_capacity(item_size_)) {
+    std::memcpy(page->items() + static_cast<size_t>(h->nitems) * item_size_,
+                item, item_size_);
+    h->nitems++;
+    store_.mark_dirty(blkno);
+    return;
+  }
+
+  // The rightmost leaf is full, compressed, or tid leaves a gap: start a new
+  // one.
+  BlockNumber newblk;
+  Page* newleaf = store_.allocate(&newblk);
+  newleaf->init(kLeafPage, 0, item_size_);
+  newleaf->header()->first_tid = tid;
+  newleaf->header()->nitems = 1;
+  std::memcpy(newleaf->items(), item, item_size_);
+  h->next = newblk;
+  store_.mark_dirty(blkno);
+
+  path.push_back(blkno);
+  insert_downlink(path, path.size() - 1, tid, newblk);
+}
+
+/*
+ * Inserts a downlink for child, whose lowest key is tid, into the parent of
+ * path[level].  path[0] is the root.
+ */
+void BTree::insert_downlink(std::vector<BlockNumber>& path, size_t level,
+                            zstid tid, BlockNumber child) {
+  if (level == 0) {
+    // Splitting the root: build a new root above the old one.
+    BlockNumber oldroot = path[0];
+    Page* old = store_.get(oldroot);
+    zstid oldkey = old->header()->first_tid;
+    uint16_t oldlevel = old->header()->level;
+
+    BlockNumber rootblk;
+    Page* root = store_.allocate(&rootblk);
+    root->init(kInternalPage, oldlevel + 1, sizeof(InternalItem));
+    root->header()->first_tid = oldkey;
+    root->header()->nitems = 2;
+    downlinks(root)[0] = InternalItem{oldkey, oldroot, 0};
+    downlinks(root)[1] = InternalItem{tid, child, 0};
+    *root_ = rootblk;
+    return;
+  }
+
+  BlockNumber parentblk = path[level - 1];
+  Page* parent = store_.get(parentblk);
+  PageHeader* h = parent->header();
+  if (h->nitems < kInternalCapacity) {
+    downlinks(parent)[h->nitems++] = InternalItem{tid, child, 0};
+    store_.mark_dirty(parentblk);
+    return;
+  }
+
+  BlockNumber newblk;
+  Page* sibling = store_.allocate(&newblk);
+  sibling->init(kInternalPage, h->level, sizeof(InternalItem));
+  sibling->header()->first_tid = tid;
+  sibling->header()->nitems = 1;
+  downlinks(sibling)[0] = InternalItem{tid, child, 0};
+  h->next = newblk;
+  store_.mark_dirty(parentblk);
+
+  insert_downlink(path, level - 1, tid, newblk);
+}
+
+unsigned char* BTree::find(zstid tid, BlockNumber* leaf) {
+  if (*root_ == kInvalidBlock)
+    return nullptr;
+
+  StatTimer timer(StatHistogram::kBTreeDescent);
+  BlockNumber blkno = *root_;
+  Page* page = store_.get(blkno);
+  uint64_t visited = 1;
+  while (page->header()->kind == kInternalPage) {
+    blkno = downlinks(page)[choose_child(page, tid)].child;
+    page = store_.get(blkno);
+    visited++;
+  }
+  timer.add(StatCounter::kBTreeDescents);
+  timer.add(StatCounter::kBTreeDescentPages, visited);
+
+  const PageHeader* h = page->header();
+  if (tid < h->first_tid || tid >= h->first_tid + h->nitems ||
+      (h->flags & kLeafCompressed))
+    return nullptr;
+  *leaf = blkno;
+  return page->items() + static_cast<size_t>(tid - h->first_tid) * item_size_;
+}
+
+BlockNumber BTree::find_leaf(zstid tid) const {
+  if (*root_ == kInvalidBlock)
+    return kInvalidBlock;
+
+  StatTimer timer(StatHistogram::kBTreeDescent);
+  Page page;
+  BlockNumber blkno = *root_;
+  store_.read(blkno, &page);
+  uint64_t visited = 1;
+  while (page.header()->kind == kInternalPage) {
+    blkno = downlinks(&page)[choose_child(&page, tid)].child;
+    store_.read(blkno, &page);
+    visited++;
+  }
+  timer.add(StatCounter::kBTreeDescents);
+  timer.add(StatCounter::kBTreeDescentPages, visited);
+  return blkno;
+}
+
+BlockNumber BTree::leftmost_leaf(PageStore& store, BlockNumber root) {
+  if (root == kInvalidBlock)
+    return kInvalidBlock;
+
+  Page page;
+  BlockNumber blkno = root;
+  store.read(blkno, &page);
+  while (page.header()->kind == kInternalPage) {
+    blkno = downlinks(&page)[0].child;
+    store.read(blkno, &page);
+  }
+  return blkno;
+}
+
+}  // namespace zs
@@ -0,0 +1,54 @@
+/*
+ * btree.h
+ *	  TID-keyed B-tree with fixed-size items.
+ *
+ * The same structure serves as the TID tree (items are TidItem) and as the
+ * per-column trees (items are the raw attribute bytes).  Because TIDs are
+ * allocated in increasing order, inserts always land on the rightmost leaf;
+ * a full page is never split in half, a new right sibling is started
+ * instead, which leaves every leaf except the last one completely packed.
+ * Appending after a bulk-loaded compressed leaf likewise starts a new,
+ * uncompressed one.
+ */
+#pragma once
+
+#include <vector>
+
+#include "storage/page_store.h"
+
+namespace zs {
+
+class BTree {
+ public:
+  // root points into the caller's metadata and is updated when the tree
+  // grows a new root.
+  BTree(PageStore& store, BlockNumber* root, uint16_t item_size);
+
+  // Appends the item for tid, which must be greater than every TID already
+  // in the tree.
+  void append(zstid tid, const void* item);
+
+  // Returns a writable pointer to the item for tid, or nullptr if the tree
+  // does not contain it or it lives on a compressed leaf.  The caller must
+  // mark_dirty() the leaf it lives on, which is returned through leaf.
+  unsigned char* find(zstid tid, BlockNumber* leaf);
+
+  // Returns the leaf that would contain tid, or kInvalidBlock for an empty
+  // tree.  Reads through PageStore::read, so it does not pin anything.
+  BlockNumber find_leaf(zstid tid) const;
+
+  uint16_t item_size() const { return item_size_; }
+
+  // Returns the leftmost leaf of the tree rooted at root.
+  static BlockNumber leftmost_leaf(PageStore& store, BlockNumber root);
+
+ private:
+  void insert_downlink(std::vector<BlockNumber>& path, size_t level,
+                       zstid tid, BlockNumber child);
+
+  PageStore& store_;
+  BlockNumber* root_;
+  uint16_t item_size_;
+};
+
+}  // namespace zs
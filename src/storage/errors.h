@@ -0,0 +1,18 @@
+/*
+ * errors.h
+ *	  Error reporting shared by every module that makes system calls.
+ */
+#pragma once
+
+#include <cerrno>
+#include <string>
+#include <system_error>
+
+namespace zs {
+
+// Throws std::system_error for the current errno, with what as the message.
+[[noreturn]] inline void throw_errno(const std::string& what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+}  // namespace zs
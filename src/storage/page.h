@@ -0,0 +1,99 @@
+/*
+ * page.h
+ *	  On-disk page layout shared by the zedstore B-trees and the row store.
+ *
+ * A zedstore file is a sequence of fixed-size blocks.  Block 0 is the
+ * metapage, which records the table's attributes and the root block of
+ * every tree.  All other blocks are B-tree pages.
+ *
+ * Every tree in the file is keyed by TID.  TIDs are handed out densely and
+ * in increasing order, so a leaf page always covers a contiguous TID range
+ * [first_tid, first_tid + nitems) and stores its items as a plain array
+ * with no per-item key.  Internal pages hold (first TID, child block)
+ * downlinks.
+ *
+ * A leaf with kLeafCompressed set instead holds a single zs_codec encoded
+ * chunk of nitems integer values after its header.  Such leaves are written
+ * only by the bulk loader and are never modified in place.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace zs {
+
+constexpr size_t kBlockSize = 8192;
+
+using BlockNumber = uint32_t;
+using TransactionId = uint32_t;
+using zstid = uint64_t;
+
+constexpr BlockNumber kInvalidBlock = 0xFFFFFFFF;
+constexpr BlockNumber kMetaBlock = 0;
+
+constexpr zstid kInvalidTid = 0;
+constexpr zstid kMinTid = 1;
+
+constexpr TransactionId kInvalidXid = 0;
+
+enum PageKind : uint16_t {
+  kInternalPage = 1,
+  kLeafPage = 2,
+  kRowPage = 3,
+};
+
+// PageHeader.flags
+constexpr uint16_t kLeafCompressed = 0x0001;
+
+struct PageHeader {
+  uint16_t kind;
+  uint16_t level;      // 0 for leaves
+  uint16_t item_size;  // bytes per item
+  uint16_t flags;
+  uint32_t nitems;
+  BlockNumber next;    // right sibling on the same level
+  zstid first_tid;     // TID of the first item
+};
+static_assert(sizeof(PageHeader) == 24, "PageHeader must stay 24 bytes");
+
+struct InternalItem {
+  zstid tid;           // lowest TID stored under child
+  BlockNumber child;
+  uint32_t pad;
+};
+
+// Visibility information kept in the TID tree, one per TID.
+struct TidItem {
+  TransactionId xmin;
+  TransactionId xmax;  // kInvalidXid while the row is live
+};
+
+struct alignas(64) Page {
+  unsigned char data[kBlockSize];
+
+  PageHeader* header() { return reinterpret_cast<PageHeader*>(data); }
+  const PageHeader* header() const {
+    return reinterpret_cast<const PageHeader*>(data);
+  }
+  unsigned char* items() { return data + sizeof(PageHeader); }
+  const unsigned char* items() const { return data + sizeof(PageHeader); }
+
+  void init(PageKind kind, uint16_t level, uint16_t item_size) {
+    PageHeader* h = header();
+    h->kind = kind;
+    h->level = level;
+    h->item_size = item_size;
+    h->flags = 0;
+    h->nitems = 0;
+    h->next = kInvalidBlock;
+    h->first_tid = kInvalidTid;
+  }
+};
+
+// Number of items of the given size that fit on one page.
+constexpr uint32_t page_capacity(size_t item_size) {
+  return static_cast<uint32_t>((kBlockSize - sizeof(PageHeader)) / item_size);
+}
+
+}  // namespace zs
@@ -0,0 +1,113 @@
+/*
+ * page_file.cc
+ *	  Block-granular access to a file on local disk.
+ */
+#include "storage/page_file.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <stdexcept>
+#include <utility>
+
+#include "stats/stats.h"
+#include "storage/errors.h"
+
+namespace zs {
+
+PageFile PageFile::create(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    throw_errno("could not create \"" + path + "\"");
+  return PageFile(fd, path);
+}
+
+PageFile PageFile::open(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDWR);
+  if (fd < 0)
+    throw_errno("could not open \"" + path + "\"");
+  return PageFile(fd, path);
+}
+
+PageFile::PageFile(PageFile&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1)),
+      path_(std::move(other.path_)),
+      stats_(other.stats_) {}
+
+PageFile& PageFile::operator=(PageFile&& other) noexcept {
+  if (this != &other) {
+    if (fd_ >= 0)
+      ::close(fd_);
+    fd_ = std::exchange(other.fd_, -1);
+    path_ = std::move(other.path_);
+    stats_ = other.stats_;
+  }
+  return *this;
+}
+
+PageFile::~PageFile() {
+  if (fd_ >= 0)
+    ::close(fd_);
+}
+
+void PageFile::read(BlockNumber blkno, Page* page) {
+  StatTimer timer(StatHistogram::kPageRead);
+  off_t offset = static_cast<off_t>(blkno) * kBlockSize;
+  size_t done = 0;
+  while (done < kBlockSize) {
+    ssize_t n = ::pread(fd_, page->data + done, kBlockSize - done,
+                        offset + static_cast<off_t>(done));
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      throw_errno("could not read block " + std::to_string(blkno) + " of \"" +
+                  path_ + "\"");
+    }
+    if (n == 0)
+      throw std::runtime_error("unexpected end of file reading block " +
+                               std::to_string(blkno) + " of \"" + path_ + "\"");
+    done += static_cast<size_t>(n);
+  }
+  stats_.pages_read++;
+  stats_.bytes_read += kBlockSize;
+  timer.add(StatCounter::kPageReads);
+  timer.add(StatCounter::kPageReadBytes, kBlockSize);
+}
+
+void PageFile::write(BlockNumber blkno, const Page* page) {
+  off_t offset = static_cast<off_t>(blkno) * kBlockSize;
+  size_t done = 0;
+  while (done < kBlockSize) {
+    ssize_t n = ::pwrite(fd_, page->data + done, kBlockSize - done,
+                         offset + static_cast<off_t>(done));
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      throw_errno("could not write block " + std::to_string(blkno) + " of \"" +
+                  path_ + "\"");
+    }
+    done += static_cast<size_t>(n);
+  }
+  stats_.pages_written++;
+  stats_.bytes_written += kBlockSize;
+}
+
+BlockNumber PageFile::nblocks() const {
+  struct stat st;
+  if (::fstat(fd_, &st) < 0)
+    throw_errno("could not stat \"" + path_ + "\"");
+  return static_cast<BlockNumber>(st.st_size / kBlockSize);
+}
+
+void PageFile::sync() {
+  if (::fsync(fd_) < 0)
+    throw_errno("could not fsync \"" + path_ + "\"");
+}
+
+void PageFile::drop_os_cache() {
+  (void) ::posix_fadvise(fd_, 0, 0, POSIX_FADV_DONTNEED);
+}
+
+}  // namespace zs
@@ -0,0 +1,61 @@
+/*
+ * page_file.h
+ *	  Block-granular access to a file on local disk.
+ *
+ * PageFile is the only place that issues read/write system calls for the
+ * storage engine, so its counters are an exact measure of the I/O a scan
+ * performed.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "storage/page.h"
+
+namespace zs {
+
+struct IoStats {
+  uint64_t pages_read = 0;
+  uint64_t bytes_read = 0;
+  uint64_t pages_written = 0;
+  uint64_t bytes_written = 0;
+};
+
+class PageFile {
+ public:
+  // Creates (truncating) or opens the file at path.  Throws std::system_error.
+  static PageFile create(const std::string& path);
+  static PageFile open(const std::string& path);
+
+  PageFile(PageFile&& other) noexcept;
+  PageFile& operator=(PageFile&& other) noexcept;
+  PageFile(const PageFile&) = delete;
+  PageFile& operator=(const PageFile&) = delete;
+  ~PageFile();
+
+  void read(BlockNumber blkno, Page* page);
+  void write(BlockNumber blkno, const Page* page);
+
+  // Number of blocks currently in the file.
+  BlockNumber nblocks() const;
+
+  void sync();
+
+  // Asks the kernel to drop this file from the page cache, so that the next
+  // scan is served from the device.  Best effort; only clean pages go.
+  void drop_os_cache();
+
+  const std::string& path() const { return path_; }
+  const IoStats& stats() const { return stats_; }
+  void reset_stats() { stats_ = IoStats(); }
+
+ private:
+  PageFile(int fd, std::string path) : fd_(fd), path_(std::move(path)) {}
+
+  int fd_ = -1;
+  std::string path_;
+  IoStats stats_;
+};
+
+}  // namespace zs
@@ -0,0 +1,66 @@
+/*
+ * page_store.cc
+ *	  Write-back page buffer used while modifying a zedstore file.
+ */
+#include "storage/page_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace zs {
+
+PageStore::PageStore(PageFile file)
+    : file_(std::move(file)), nblocks_(file_.nblocks()) {}
+
+Page* PageStore::get(BlockNumber blkno) {
+  auto it = pages_.find(blkno);
+  if (it != pages_.end())
+    return it->second.page.get();
+
+  Entry entry;
+  entry.page = std::make_unique<Page>();
+  file_.read(blkno, entry.page.get());
+  Page* page = entry.page.get();
+  pages_.emplace(blkno, std::move(entry));
+  return page;
+}
+
+Page* PageStore::allocate(BlockNumber* blkno) {
+  *blkno = nblocks_++;
+  Entry entry;
+  entry.page = std::make_unique<Page>();
+  std::memset(entry.page->data, 0, kBlockSize);
+  entry.dirty = true;
+  Page* page = entry.page.get();
+  pages_.emplace(*blkno, std::move(entry));
+  return page;
+}
+
+void PageStore::mark_dirty(BlockNumber blkno) {
+  pages_.at(blkno).dirty = true;
+}
+
+void PageStore::read(BlockNumber blkno, Page* dst) {
+  auto it = pages_.find(blkno);
+  if (it != pages_.end()) {
+    std::memcpy(dst->data, it->second.page->data, kBlockSize);
+    return;
+  }
+  file_.read(blkno, dst);
+}
+
+void PageStore::flush() {
+  // Write in block order so that newly allocated blocks extend the file
+  // sequentially.
+  std::vector<BlockNumber> dirty;
+  for (const auto& [blkno, entry] : pages_)
+    if (entry.dirty)
+      dirty.push_back(blkno);
+  std::sort(dirty.begin(), dirty.end());
+  for (BlockNumber blkno : dirty)
+    file_.write(blkno, pages_[blkno].page.get());
+  pages_.clear();
+}
+
+}  // namespace zs
@@ -0,0 +1,54 @@
+/*
+ * page_store.h
+ *	  Write-back page buffer used while modifying a zedstore file.
+ *
+ * Writers get pages through PageStore, which keeps every page it has handed
+ * out in memory until flush().  This is deliberately simple: the insert path
+ * only ever touches the rightmost path of each tree, so the working set is
+ * tiny, and flush() is called often enough to keep the buffer bounded.
+ */
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+
+#include "storage/page_file.h"
+
+namespace zs {
+
+class PageStore {
+ public:
+  explicit PageStore(PageFile file);
+
+  // Returns the buffered copy of blkno, reading it in if necessary.  The
+  // pointer is valid until the next flush().
+  Page* get(BlockNumber blkno);
+
+  // Allocates a new block at the end of the file and returns its buffer.
+  Page* allocate(BlockNumber* blkno);
+
+  void mark_dirty(BlockNumber blkno);
+
+  // Copies blkno into dst, preferring the buffered version so that readers
+  // see unflushed changes.
+  void read(BlockNumber blkno, Page* dst);
+
+  // Writes out dirty pages and empties the buffer.
+  void flush();
+
+  size_t buffered() const { return pages_.size(); }
+  BlockNumber nblocks() const { return nblocks_; }
+  PageFile& file() { return file_; }
+
+ private:
+  struct Entry {
+    std::unique_ptr<Page> page;
+    bool dirty = false;
+  };
+
+  PageFile file_;
+  BlockNumber nblocks_;
+  std::unordered_map<BlockNumber, Entry> pages_;
+};
+
+}  // namespace zs
@@ -0,0 +1,128 @@
+/*
+ * relation.cc
+ *	  A zedstore table: one TID tree for visibility plus one B-tree per
+ *	  column, all keyed by TID and stored in a single file.
+ */
+#include "storage/relation.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace zs {
+
+namespace {
+
+// Keep the write buffer bounded during long loads.
+constexpr size_t kMaxBufferedPages = 8192;
+
+MetaAttribute* meta_attributes(Page* page) {
+  return reinterpret_cast<MetaAttribute*>(page->data + sizeof(MetaPageData));
+}
+
+}  // namespace
+
+Relation::Relation(PageFile file, Schema schema)
+    : store_(std::move(file)),
+      schema_(std::move(schema)),
+      column_roots_(schema_.natts(), kInvalidBlock) {}
+
+std::unique_ptr<Relation> Relation::create(const std::string& path,
+                                           const Schema& schema) {
+  if (schema.natts() == 0 ||
+      static_cast<size_t>(schema.natts()) > kMaxAttributes)
+    throw std::invalid_argument("unsupported number of attributes: " +
+                                std::to_string(schema.natts()));
+  for (int i = 0; i < schema.natts(); i++)
+    if (schema.attlen(i) == 0 || page_capacity(schema.attlen(i)) == 0)
+      throw std::invalid_argument("unsupported attribute length " +
+                                  std::to_string(schema.attlen(i)));
+
+  std::unique_ptr<Relation> rel(new Relation(PageFile::create(path), schema));
+  BlockNumber metablk;
+  rel->store_.allocate(&metablk);
+  rel->write_meta();
+  rel->flush();
+  return rel;
+}
+
+std::unique_ptr<Relation> Relation::open(const std::string& path) {
+  PageFile file = PageFile::open(path);
+  Page meta;
+  file.read(kMetaBlock, &meta);
+
+  MetaPageData data;
+  std::memcpy(&data, meta.data, sizeof(data));
+  if (data.magic != kZedstoreMagic || data.version != kZedstoreVersion)
+    throw std::runtime_error("\"" + path + "\" is not a zedstore file");
+  if (data.natts == 0 || data.natts > kMaxAttributes)
+    throw std::runtime_error("corrupt metapage in \"" + path + "\"");
+
+  const MetaAttribute* atts = meta_attributes(&meta);
+  std::vector<uint16_t> attlens;
+  for (int i = 0; i < data.natts; i++)
+    attlens.push_back(atts[i].attlen);
+
+  std::unique_ptr<Relation> rel(
+      new Relation(std::move(file), Schema(std::move(attlens))));
+  rel->next_tid_ = data.next_tid;
+  rel->tid_root_ = data.tid_root;
+  for (int i = 0; i < data.natts; i++)
+    rel->column_roots_[i] = atts[i].root;
+  return rel;
+}
+
+zstid Relation::insert(const unsigned char* row, TransactionId xid) {
+  zstid tid = next_tid_++;
+
+  TidItem item{xid, kInvalidXid};
+  BTree(store_, &tid_root_, sizeof(TidItem)).append(tid, &item);
+  for (int i = 0; i < schema_.natts(); i++)
+    BTree(store_, &column_roots_[i], schema_.attlen(i))
+        .append(tid, row + schema_.offset(i));
+
+  if (store_.buffered() >= kMaxBufferedPages)
+    flush();
+  return tid;
+}
+
+bool Relation::remove(zstid tid, TransactionId xid) {
+  BlockNumber leaf;
+  unsigned char* p =
+      BTree(store_, &tid_root_, sizeof(TidItem)).find(tid, &leaf);
+  if (p == nullptr)
+    return false;
+
+  TidItem item;
+  std::memcpy(&item, p, sizeof(item));
+  if (item.xmax != kInvalidXid)
+    return false;
+  item.xmax = xid;
+  std::memcpy(p, &item, sizeof(item));
+  store_.mark_dirty(leaf);
+  return true;
+}
+
+void Relation::write_meta() {
+  Page* meta = store_.get(kMetaBlock);
+  std::memset(meta->data, 0, kBlockSize);
+
+  MetaPageData data{};
+  data.magic = kZedstoreMagic;
+  data.version = kZedstoreVersion;
+  data.natts = static_cast<uint16_t>(schema_.natts());
+  data.next_tid = next_tid_;
+  data.tid_root = tid_root_;
+  std::memcpy(meta->data, &data, sizeof(data));
+
+  MetaAttribute* atts = meta_attributes(meta);
+  for (int i = 0; i < schema_.natts(); i++)
+    atts[i] = MetaAttribute{schema_.attlen(i), 0, column_roots_[i]};
+  store_.mark_dirty(kMetaBlock);
+}
+
+void Relation::flush() {
+  write_meta();
+  store_.flush();
+}
+
+}  // namespace zs
@@ -0,0 +1,81 @@
+/*
+ * relation.h
+ *	  A zedstore table: one TID tree for visibility plus one B-tree per
+ *	  column, all keyed by TID and stored in a single file.
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "storage/btree.h"
+#include "storage/schema.h"
+
+namespace zs {
+
+constexpr uint32_t kZedstoreMagic = 0x5A454453;  // "ZEDS"
+constexpr uint16_t kZedstoreVersion = 1;
+
+struct MetaPageData {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t natts;
+  zstid next_tid;
+  BlockNumber tid_root;
+  uint32_t pad;
+  // followed by natts MetaAttribute entries
+};
+
+struct MetaAttribute {
+  uint16_t attlen;
+  uint16_t pad;
+  BlockNumber root;
+};
+
+constexpr size_t kMaxAttributes =
+    (kBlockSize - sizeof(MetaPageData)) / sizeof(MetaAttribute);
+
+// Transactions with an id below xid are treated as committed.
+struct Snapshot {
+  TransactionId xid;
+
+  bool visible(const TidItem& item) const {
+    return item.xmin < xid && (item.xmax == kInvalidXid || item.xmax >= xid);
+  }
+};
+
+class Relation {
+ public:
+  static std::unique_ptr<Relation> create(const std::string& path,
+                                          const Schema& schema);
+  static std::unique_ptr<Relation> open(const std::string& path);
+
+  // Inserts a row in Schema row format and returns its TID.
+  zstid insert(const unsigned char* row, TransactionId xid);
+
+  // Marks tid as deleted by xid.  Returns false if there is no such row.
+  bool remove(zstid tid, TransactionId xid);
+
+  // Writes out all buffered pages and the metapage.
+  void flush();
+
+  const Schema& schema() const { return schema_; }
+  zstid next_tid() const { return next_tid_; }
+  BlockNumber tid_root() const { return tid_root_; }
+  BlockNumber column_root(int attno) const { return column_roots_[attno]; }
+  PageStore& store() { return store_; }
+
+ private:
+  Relation(PageFile file, Schema schema);
+
+  void write_meta();
+
+  PageStore store_;
+  Schema schema_;
+  zstid next_tid_ = kMinTid;
+  BlockNumber tid_root_ = kInvalidBlock;
+  std::vector<BlockNumber> column_roots_;
+};
+
+}  // namespace zs
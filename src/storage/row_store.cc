@@ -0,0 +1,165 @@
+/*
+ * row_store.cc
+ *	  Row-oriented baseline table, for comparison with zedstore.
+ */
+#include "storage/row_store.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace zs {
+
+namespace {
+
+struct RowMetaData {
+  uint32_t magic;
+  uint16_t natts;
+  uint16_t pad;
+  zstid next_tid;
+  BlockNumber nblocks;
+  uint32_t pad2;
+  // followed by natts uint16_t attribute lengths
+};
+
+}  // namespace
+
+RowStore::RowStore(PageFile file, Schema schema)
+    : file_(std::move(file)),
+      schema_(std::move(schema)),
+      rows_per_page_(
+          page_capacity(sizeof(TidItem) + schema_.row_width())) {
+  if (rows_per_page_ == 0)
+    throw std::invalid_argument("row too wide for a page");
+}
+
+std::unique_ptr<RowStore> RowStore::create(const std::string& path,
+                                           const Schema& schema) {
+  if (schema.natts() == 0 ||
+      sizeof(RowMetaData) + schema.natts() * sizeof(uint16_t) > kBlockSize)
+    throw std::invalid_argument("unsupported number of attributes: " +
+                                std::to_string(schema.natts()));
+  std::unique_ptr<RowStore> rs(new RowStore(PageFile::create(path), schema));
+  rs->flush();
+  return rs;
+}
+
+std::unique_ptr<RowStore> RowStore::open(const std::string& path) {
+  PageFile file = PageFile::open(path);
+  Page meta;
+  file.read(kMetaBlock, &meta);
+
+  RowMetaData data;
+  std::memcpy(&data, meta.data, sizeof(data));
+  if (data.magic != kRowStoreMagic)
+    throw std::runtime_error("\"" + path + "\" is not a row store file");
+
+  std::vector<uint16_t> attlens(data.natts);
+  std::memcpy(attlens.data(), meta.data + sizeof(data),
+              data.natts * sizeof(uint16_t));
+
+  std::unique_ptr<RowStore> rs(
+      new RowStore(std::move(file), Schema(std::move(attlens))));
+  rs->next_tid_ = data.next_tid;
+  rs->nblocks_ = data.nblocks;
+  return rs;
+}
+
+zstid RowStore::insert(const unsigned char* row, TransactionId xid) {
+  if (!have_current_ || current_.header()->nitems == rows_per_page_) {
+    if (have_current_)
+      file_.write(nblocks_ - 1, &current_);
+    std::memset(current_.data, 0, kBlockSize);
+    current_.init(kRowPage, 0,
+                  static_cast<uint16_t>(sizeof(TidItem) + schema_.row_width()));
+    current_.header()->first_tid = next_tid_;
+    nblocks_++;
+    have_current_ = true;
+  }
+
+  zstid tid = next_tid_++;
+  PageHeader* h = current_.header();
+  unsigned char* p =
+      current_.items() + static_cast<size_t>(h->nitems) * h->item_size;
+  TidItem item{xid, kInvalidXid};
+  std::memcpy(p, &item, sizeof(item));
+  std::memcpy(p + sizeof(item), row, schema_.row_width());
+  h->nitems++;
+  return tid;
+}
+
+void RowStore::flush() {
+  if (have_current_)
+    file_.write(nblocks_ - 1, &current_);
+
+  Page meta;
+  std::memset(meta.data, 0, kBlockSize);
+  RowMetaData data{};
+  data.magic = kRowStoreMagic;
+  data.natts = static_cast<uint16_t>(schema_.natts());
+  data.next_tid = next_tid_;
+  data.nblocks = nblocks_;
+  std::memcpy(meta.data, &data, sizeof(data));
+  for (int i = 0; i < schema_.natts(); i++) {
+    uint16_t len = schema_.attlen(i);
+    std::memcpy(meta.data + sizeof(data) + i * sizeof(uint16_t), &len,
+                sizeof(len));
+  }
+  file_.write(kMetaBlock, &meta);
+}
+
+RowScan::RowScan(RowStore& store, std::vector<int> attnos, Snapshot snapshot)
+    : store_(store), attnos_(std::move(attnos)), snapshot_(snapshot) {
+  for (int attno : attnos_)
+    if (attno < 0 || attno >= store.schema().natts())
+      throw std::out_of_range("invalid attribute number " +
+                              std::to_string(attno));
+}
+
+bool RowScan::next(ScanBatch& batch) {
+  const Schema& schema = store_.schema();
+  size_t ncols = attnos_.size();
+
+  batch.nrows = 0;
+  batch.tids.resize(kScanBatchSize);
+  batch.columns.resize(ncols);
+  for (size_t c = 0; c < ncols; c++)
+    batch.columns[c].resize(kScanBatchSize * schema.attlen(attnos_[c]));
+
+  while (batch.nrows < kScanBatchSize) {
+    if (!loaded_) {
+      if (blkno_ >= store_.nblocks())
+        break;
+      store_.file().read(blkno_, &page_);
+      loaded_ = true;
+      pos_ = 0;
+    }
+    const PageHeader* h = page_.header();
+    if (pos_ == h->nitems) {
+      blkno_++;
+      loaded_ = false;
+      continue;
+    }
+
+    const unsigned char* p =
+        page_.items() + static_cast<size_t>(pos_) * h->item_size;
+    zstid tid = h->first_tid + pos_++;
+    TidItem item;
+    std::memcpy(&item, p, sizeof(item));
+    if (!snapshot_.visible(item))
+      continue;
+
+    const unsigned char* row = p + sizeof(item);
+    size_t out = batch.nrows++;
+    batch.tids[out] = tid;
+    for (size_t c = 0; c < ncols; c++) {
+      int attno = attnos_[c];
+      uint16_t attlen = schema.attlen(attno);
+      std::memcpy(batch.columns[c].data() + out * attlen,
+                  row + schema.offset(attno), attlen);
+    }
+  }
+  batch.tids.resize(batch.nrows);
+  return batch.nrows > 0;
+}
+
+}  // namespace zs
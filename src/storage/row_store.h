@@ -0,0 +1,69 @@
+/*
+ * row_store.h
+ *	  Row-oriented baseline table, for comparison with zedstore.
+ *
+ * This is a minimal heap: rows are appended to pages in insertion order,
+ * each preceded by its TidItem header, in the same row format zedstore
+ * accepts.  Any scan has to read every page regardless of how many columns
+ * it projects, which is exactly the cost the columnar layout avoids.
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "storage/page_file.h"
+#include "storage/relation.h"
+#include "storage/table_scan.h"
+
+namespace zs {
+
+constexpr uint32_t kRowStoreMagic = 0x524F5753;  // "ROWS"
+
+class RowStore {
+ public:
+  static std::unique_ptr<RowStore> create(const std::string& path,
+                                          const Schema& schema);
+  static std::unique_ptr<RowStore> open(const std::string& path);
+
+  zstid insert(const unsigned char* row, TransactionId xid);
+
+  // Writes out the partially filled last page and the metapage.
+  void flush();
+
+  const Schema& schema() const { return schema_; }
+  zstid next_tid() const { return next_tid_; }
+  BlockNumber nblocks() const { return nblocks_; }
+  uint32_t rows_per_page() const { return rows_per_page_; }
+  PageFile& file() { return file_; }
+
+ private:
+  RowStore(PageFile file, Schema schema);
+
+  PageFile file_;
+  Schema schema_;
+  uint32_t rows_per_page_;
+  zstid next_tid_ = kMinTid;
+  BlockNumber nblocks_ = 1;  // block 0 is the metapage
+  Page current_;             // page being filled, block nblocks_ - 1
+  bool have_current_ = false;
+};
+
+class RowScan {
+ public:
+  RowScan(RowStore& store, std::vector<int> attnos, Snapshot snapshot);
+
+  bool next(ScanBatch& batch);
+
+ private:
+  RowStore& store_;
+  std::vector<int> attnos_;
+  Snapshot snapshot_;
+  BlockNumber blkno_ = 1;
+  uint32_t pos_ = 0;
+  Page page_;
+  bool loaded_ = false;
+};
+
+}  // namespace zs
@@ -0,0 +1,39 @@
+/*
+ * schema.h
+ *	  Fixed-width table layout.
+ *
+ * Rows are passed around in "row format": the attributes packed back to
+ * back in attribute order with no alignment padding.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zs {
+
+class Schema {
+ public:
+  Schema() = default;
+  explicit Schema(std::vector<uint16_t> attlens)
+      : attlens_(std::move(attlens)) {
+    offsets_.reserve(attlens_.size());
+    for (uint16_t len : attlens_) {
+      offsets_.push_back(row_width_);
+      row_width_ += len;
+    }
+  }
+
+  int natts() const { return static_cast<int>(attlens_.size()); }
+  uint16_t attlen(int attno) const { return attlens_[attno]; }
+  size_t offset(int attno) const { return offsets_[attno]; }
+  size_t row_width() const { return row_width_; }
+
+ private:
+  std::vector<uint16_t> attlens_;
+  std::vector<size_t> offsets_;
+  size_t row_width_ = 0;
+};
+
+}  // namespace zs
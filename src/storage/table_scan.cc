@@ -0,0 +1,126 @@
+/*
+ * table_scan.cc
+ *	  Column-projected sequential scan over a zedstore Relation.
+ */
+#include "storage/table_scan.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "codec/codec.h"
+
+namespace zs {
+
+LeafCursor::LeafCursor(PageStore& store, BlockNumber first_leaf)
+    : store_(store), blkno_(first_leaf) {}
+
+const unsigned char* LeafCursor::seek(zstid tid) {
+  for (;;) {
+    if (blkno_ == kInvalidBlock)
+      return nullptr;
+    if (!loaded_) {
+      store_.read(blkno_, &page_);
+      loaded_ = true;
+      if (page_.header()->flags & kLeafCompressed)
+        decompress();
+      else
+        items_ = page_.items();
+    }
+
+    const PageHeader* h = page_.header();
+    if (tid < h->first_tid)
+      return nullptr;
+    if (tid < h->first_tid + h->nitems)
+      return items_ + static_cast<size_t>(tid - h->first_tid) * h->item_size;
+
+    blkno_ = h->next;
+    loaded_ = false;
+  }
+}
+
+void LeafCursor::decompress() {
+  const PageHeader* h = page_.header();
+  Decoder decoder(page_.items(), kBlockSize - sizeof(PageHeader));
+  if (decoder.count() != h->nitems)
+    throw std::runtime_error("compressed leaf " + std::to_string(blkno_) +
+                             " holds " + std::to_string(decoder.count()) +
+                             " values, header says " +
+                             std::to_string(h->nitems));
+
+  decoded_.resize(h->nitems + kPackBlockValues);
+  decoder.decode_all(decoded_.data());
+
+  switch (h->item_size) {
+    case sizeof(int64_t):
+      items_ = reinterpret_cast<const unsigned char*>(decoded_.data());
+      break;
+    case sizeof(int32_t): {
+      narrowed_.resize(h->nitems * sizeof(int32_t));
+      int32_t* out = reinterpret_cast<int32_t*>(narrowed_.data());
+      for (uint32_t i = 0; i < h->nitems; i++)
+        out[i] = static_cast<int32_t>(decoded_[i]);
+      items_ = narrowed_.data();
+      break;
+    }
+    default:
+      throw std::runtime_error("compressed leaf " + std::to_string(blkno_) +
+                               " has unsupported item size " +
+                               std::to_string(h->item_size));
+  }
+}
+
+TableScan::TableScan(Relation& rel, std::vector<int> attnos, Snapshot snapshot)
+    : rel_(rel),
+      attnos_(std::move(attnos)),
+      snapshot_(snapshot),
+      tid_cursor_(rel.store(),
+                  BTree::leftmost_leaf(rel.store(), rel.tid_root())) {
+  for (int attno : attnos_) {
+    if (attno < 0 || attno >= rel.schema().natts())
+      throw std::out_of_range("invalid attribute number " +
+                              std::to_string(attno));
+    column_cursors_.emplace_back(
+        rel.store(),
+        BTree::leftmost_leaf(rel.store(), rel.column_root(attno)));
+  }
+}
+
+bool TableScan::next(ScanBatch& batch) {
+  const Schema& schema = rel_.schema();
+  size_t ncols = attnos_.size();
+
+  batch.nrows = 0;
+  batch.tids.resize(kScanBatchSize);
+  batch.columns.resize(ncols);
+  for (size_t c = 0; c < ncols; c++)
+    batch.columns[c].resize(kScanBatchSize * schema.attlen(attnos_[c]));
+
+  zstid end = rel_.next_tid();
+  while (batch.nrows < kScanBatchSize && tid_ < end) {
+    zstid tid = tid_++;
+    const unsigned char* p = tid_cursor_.seek(tid);
+    if (p == nullptr)
+      throw std::runtime_error("TID " + std::to_string(tid) +
+                               " missing from TID tree");
+    TidItem item;
+    std::memcpy(&item, p, sizeof(item));
+    if (!snapshot_.visible(item))
+      continue;
+
+    size_t row = batch.nrows++;
+    batch.tids[row] = tid;
+    for (size_t c = 0; c < ncols; c++) {
+      uint16_t attlen = schema.attlen(attnos_[c]);
+      const unsigned char* value = column_cursors_[c].seek(tid);
+      if (value == nullptr)
+        throw std::runtime_error("TID " + std::to_string(tid) +
+                                 " missing from column " +
+                                 std::to_string(attnos_[c]));
+      std::memcpy(batch.columns[c].data() + row * attlen, value, attlen);
+    }
+  }
+  batch.tids.resize(batch.nrows);
+  return batch.nrows > 0;
+}
+
+}  // namespace zs
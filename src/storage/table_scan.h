@@ -0,0 +1,67 @@
+/*
+ * table_scan.h
+ *	  Column-projected sequential scan over a zedstore Relation.
+ *
+ * The scan walks the leaf level of the TID tree to decide visibility, and
+ * the leaf level of each projected column tree in lockstep with it.  Trees
+ * of columns that are not projected are never read.
+ */
+#pragma once
+
+#include <vector>
+
+#include "storage/page_store.h"
+#include "storage/relation.h"
+
+namespace zs {
+
+constexpr size_t kScanBatchSize = 1024;
+
+// One batch of scan output.  The first nrows values in columns[i] belong to
+// the i'th projected attribute, packed back to back.
+struct ScanBatch {
+  size_t nrows = 0;
+  std::vector<zstid> tids;
+  std::vector<std::vector<unsigned char>> columns;
+};
+
+// Sequential reader of one tree's leaf level.  Compressed leaves are
+// decoded in full when the cursor reaches them.
+class LeafCursor {
+ public:
+  LeafCursor(PageStore& store, BlockNumber first_leaf);
+
+  // Positions the cursor on the leaf that holds tid, moving right as needed.
+  // Returns a pointer to its item, or nullptr if the tree has no such TID.
+  const unsigned char* seek(zstid tid);
+
+ private:
+  void decompress();
+
+  PageStore& store_;
+  BlockNumber blkno_;
+  Page page_;
+  bool loaded_ = false;
+  const unsigned char* items_ = nullptr;
+  std::vector<int64_t> decoded_;
+  std::vector<unsigned char> narrowed_;
+};
+
+class TableScan {
+ public:
+  TableScan(Relation& rel, std::vector<int> attnos, Snapshot snapshot);
+
+  // Fills batch with up to kScanBatchSize visible rows.  Returns false once
+  // the scan is exhausted.
+  bool next(ScanBatch& batch);
+
+ private:
+  Relation& rel_;
+  std::vector<int> attnos_;
+  Snapshot snapshot_;
+  zstid tid_ = kMinTid;
+  LeafCursor tid_cursor_;
+  std::vector<LeafCursor> column_cursors_;
+};
+
+}  // namespace zs
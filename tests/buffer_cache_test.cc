@@ -0,0 +1,117 @@
+/*
+ * buffer_cache_test.cc
+ *	  Tests for the shared buffer cache's mapping table.
+ */
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <unistd.h>
+
+#include "cache/buffer_cache.h"
+#include "stats/stats.h"
+#include "storage/page_file.h"
+
+#include "check.h"
+
+using namespace zs;
+
+namespace {
+
+// Mirrors BufferCache: with 32 buffers the table has 16 buckets, and a
+// block of file 0 hashes by Fibonacci hashing of its block number.
+constexpr size_t kBuffers = 32;
+constexpr uint32_t kBucketMask = 15;
+
+uint32_t home_bucket(BlockNumber blkno) {
+  return static_cast<uint32_t>((blkno * 0x9E3779B97F4A7C15ULL) >> 32) &
+         kBucketMask;
+}
+
+std::string write_file(BlockNumber npages) {
+  std::string path = "buffer_cache_test.data";
+  PageFile file = PageFile::create(path);
+  Page page;
+  std::memset(page.data, 0, kBlockSize);
+  for (BlockNumber blkno = 0; blkno < npages; blkno++) {
+    std::memcpy(page.data, &blkno, sizeof(blkno));
+    file.write(blkno, &page);
+  }
+  file.sync();
+  return path;
+}
+
+BlockNumber page_block(const PageRef& ref) {
+  BlockNumber blkno;
+  std::memcpy(&blkno, ref.data(), sizeof(blkno));
+  return blkno;
+}
+
+// Fill bucket 0 so that a sixteenth block overflows into bucket 1, then
+// evict the others so that bucket 0 has free slots again.  The overflowed
+// block must still be found, not looked up as a miss forever.
+void test_overflowed_entry_after_home_bucket_frees() {
+  const BlockNumber kPages = 4096;
+  std::string path = write_file(kPages);
+  BufferCache cache(kBuffers);
+  FileId file = cache.add_file(path);
+
+  std::vector<BlockNumber> colliding, others;
+  for (BlockNumber b = 0; b < kPages; b++) {
+    uint32_t bucket = home_bucket(b);
+    if (bucket == 0)
+      colliding.push_back(b);
+    else if (bucket > 3)  // well clear of bucket 0's probe range
+      others.push_back(b);
+  }
+  CHECK(colliding.size() >= 16);
+  CHECK(others.size() >= 4 * kBuffers);
+
+  for (int i = 0; i < 15; i++)
+    CHECK(page_block(cache.read(file, colliding[i])) == colliding[i]);
+  BlockNumber overflowed = colliding[15];
+  PageRef held = cache.read(file, overflowed);
+  CHECK(page_block(held) == overflowed);
+
+  for (size_t i = 0; i < 4 * kBuffers; i++)
+    CHECK(page_block(cache.read(file, others[i])) == others[i]);
+
+  CacheStats before = cache.stats();
+  PageRef again = cache.read(file, overflowed);
+  CHECK(page_block(again) == overflowed);
+  CacheStats after = cache.stats();
+  CHECK(after.hits == before.hits + 1);
+  CHECK(after.misses == before.misses);
+
+  ::unlink(path.c_str());
+}
+
+// A read past the end of the file fails in either mode, and is not counted
+// as a page read.
+void test_failed_read_not_counted(BufferCache::ReadMode mode) {
+  std::string path = write_file(4);
+  BufferCache cache(kBuffers, mode);
+  FileId file = cache.add_file(path);
+  CHECK(page_block(cache.read(file, 3)) == 3);
+
+  StatsSnapshot before = stats_snapshot();
+  CHECK_THROWS(cache.read(file, 4), std::system_error);
+  StatsSnapshot after = stats_snapshot();
+  CHECK(after.counter(StatCounter::kPageReads) ==
+        before.counter(StatCounter::kPageReads));
+  CHECK(after.counter(StatCounter::kPageReadBytes) ==
+        before.counter(StatCounter::kPageReadBytes));
+
+  ::unlink(path.c_str());
+}
+
+}  // namespace
+
+int main() {
+  test_overflowed_entry_after_home_bucket_frees();
+  test_failed_read_not_counted(BufferCache::ReadMode::kPread);
+  test_failed_read_not_counted(BufferCache::ReadMode::kMmap);
+  return 0;
+}
@@ -0,0 +1,36 @@
+/*
+ * check.h
+ *	  Minimal assertions for the unit tests.
+ *
+ * Each test is a plain executable: a failed check prints where it failed
+ * and exits nonzero, which is all ctest needs.
+ */
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+#define CHECK(cond)                                                      \
+  do {                                                                   \
+    if (!(cond)) {                                                       \
+      std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__,        \
+                   __LINE__, #cond);                                     \
+      std::exit(1);                                                      \
+    }                                                                    \
+  } while (0)
+
+// Checks that stmt throws an exception of type E (or derived from it).
+#define CHECK_THROWS(stmt, E)                                            \
+  do {                                                                   \
+    bool threw_ = false;                                                 \
+    try {                                                                \
+      stmt;                                                              \
+    } catch (const E&) {                                                 \
+      threw_ = true;                                                     \
+    }                                                                    \
+    if (!threw_) {                                                       \
+      std::fprintf(stderr, "%s:%d: %s did not throw %s\n", __FILE__,     \
+                   __LINE__, #stmt, #E);                                 \
+      std::exit(1);                                                      \
+    }                                                                    \
+  } while (0)
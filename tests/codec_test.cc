@@ -0,0 +1,133 @@
+/*
+ * codec_test.cc
+ *	  Round-trip tests for the column codecs on every supported ISA.
+ */
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "codec/codec.h"
+
+#include "check.h"
+
+using namespace zs;
+
+namespace {
+
+const Codec kCodecs[] = {Codec::kFor, Codec::kDelta, Codec::kBitPack,
+                         Codec::kRle};
+const Isa kIsas[] = {Isa::kScalar, Isa::kSse42, Isa::kAvx2};
+
+// Sizes around the block (256) and batch (1024) boundaries.
+const size_t kSizes[] = {0, 1, 255, 256, 257, 1025};
+
+std::vector<unsigned char> encoded(Codec codec,
+                                   const std::vector<int64_t>& values) {
+  std::vector<unsigned char> buf;
+  encode(codec, values.data(), values.size(), buf);
+  return buf;
+}
+
+unsigned bit_width(const std::vector<unsigned char>& buf) {
+  EncodedHeader h;
+  std::memcpy(&h, buf.data(), sizeof(h));
+  return h.bit_width;
+}
+
+void check_round_trip(const std::vector<int64_t>& values) {
+  for (Codec codec : kCodecs) {
+    std::vector<unsigned char> buf = encoded(codec, values);
+    CHECK(buf.size() == encoded_size(codec, values.data(), values.size()));
+    for (Isa isa : kIsas) {
+      if (!isa_supported(isa))
+        continue;
+      Decoder dec(buf.data(), buf.size(), isa);
+      CHECK(dec.codec() == codec);
+      CHECK(dec.count() == values.size());
+      std::vector<int64_t> out(values.size() + kPackBlockValues);
+      dec.decode_all(out.data());
+      CHECK(std::memcmp(out.data(), values.data(),
+                        values.size() * sizeof(int64_t)) == 0);
+    }
+  }
+}
+
+// All zeros: every bit-packed codec needs width 0.
+void test_width_zero() {
+  for (size_t n : kSizes) {
+    std::vector<int64_t> values(n, 0);
+    if (n > 0) {
+      CHECK(bit_width(encoded(Codec::kFor, values)) == 0);
+      CHECK(bit_width(encoded(Codec::kDelta, values)) == 0);
+      CHECK(bit_width(encoded(Codec::kBitPack, values)) == 0);
+    }
+    check_round_trip(values);
+  }
+}
+
+// Values swinging between the int64 extremes need the full 64 bits in every
+// bit-packed codec.
+void test_width_64() {
+  const int64_t extremes[] = {std::numeric_limits<int64_t>::min(),
+                              std::numeric_limits<int64_t>::max(), -1, 0};
+  for (size_t n : kSizes) {
+    std::vector<int64_t> values(n);
+    for (size_t i = 0; i < n; i++)
+      values[i] = extremes[i % 4];
+    if (n > 1) {
+      CHECK(bit_width(encoded(Codec::kFor, values)) == 64);
+      CHECK(bit_width(encoded(Codec::kDelta, values)) == 64);
+      CHECK(bit_width(encoded(Codec::kBitPack, values)) == 64);
+    }
+    check_round_trip(values);
+  }
+}
+
+// A mix of run lengths, including one run that crosses a batch boundary.
+void test_runs() {
+  for (size_t n : kSizes) {
+    std::vector<int64_t> values(n);
+    for (size_t i = 0; i < n; i++)
+      values[i] = i < 700 ? static_cast<int64_t>(i / 7) * -3 : 1000;
+    check_round_trip(values);
+  }
+}
+
+// An RLE header whose run lengths do not add up to the count must be
+// rejected rather than decoded short or past its payload.
+void test_rejects_corrupt_rle() {
+  std::vector<int64_t> values = {5, 5, 5, 9, 9, 2};
+  std::vector<unsigned char> buf = encoded(Codec::kRle, values);
+  EncodedHeader h;
+  std::memcpy(&h, buf.data(), sizeof(h));
+  CHECK(h.nruns == 3);
+  size_t first_len = sizeof(EncodedHeader) + h.nruns * sizeof(int64_t);
+
+  for (int adjust : {1, -1}) {
+    std::vector<unsigned char> bad = buf;
+    uint32_t len;
+    std::memcpy(&len, bad.data() + first_len, sizeof(len));
+    len += adjust;
+    std::memcpy(bad.data() + first_len, &len, sizeof(len));
+    CHECK_THROWS(Decoder(bad.data(), bad.size(), Isa::kScalar),
+                 std::invalid_argument);
+  }
+
+  std::vector<unsigned char> bad = buf;
+  h.count = 7;
+  std::memcpy(bad.data(), &h, sizeof(h));
+  CHECK_THROWS(Decoder(bad.data(), bad.size(), Isa::kScalar),
+               std::invalid_argument);
+}
+
+}  // namespace
+
+int main() {
+  test_width_zero();
+  test_width_64();
+  test_runs();
+  test_rejects_corrupt_rle();
+  return 0;
+}
@@ -0,0 +1,234 @@
+/*
+ * loader_test.cc
+ *	  Tests for the bulk loader and its input formats.
+ */
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "loader/bulk_loader.h"
+#include "loader/input.h"
+#include "storage/relation.h"
+#include "storage/schema.h"
+#include "storage/table_scan.h"
+
+#include "check.h"
+
+using namespace zs;
+
+namespace {
+
+const char* const kPath = "loader_test.zs";
+
+// Loads text as CSV into a fresh two-column table, int64 then int32, and
+// returns the number of rows loaded.
+uint64_t load_text(const std::string& text) {
+  BulkLoader loader(kPath, Schema({8, 4}), LoadOptions());
+  std::FILE* in = ::fmemopen(const_cast<char*>(text.data()), text.size(), "r");
+  CHECK(in != nullptr);
+  try {
+    load_csv(in, loader);
+  } catch (...) {
+    std::fclose(in);
+    throw;
+  }
+  std::fclose(in);
+  return loader.finish().rows;
+}
+
+void test_csv_limits() {
+  CHECK(load_text("-9223372036854775808,-2147483648\n"
+                  "9223372036854775807,2147483647\n") == 2);
+  ::unlink(kPath);
+}
+
+// Out-of-range fields must be rejected before the accumulator overflows.
+void test_csv_out_of_range() {
+  CHECK_THROWS(load_text("12345678901234567890,1\n"), std::runtime_error);
+  CHECK_THROWS(load_text("-99999999999999999999,1\n"), std::runtime_error);
+  CHECK_THROWS(load_text("9223372036854775808,1\n"), std::runtime_error);
+  CHECK_THROWS(load_text("1,2147483648\n"), std::runtime_error);
+  ::unlink(kPath);
+}
+
+// A batch with a short column is rejected as a whole, and leaves the loader
+// usable with every column still at the same row.
+void test_add_rejects_ragged_batch() {
+  BulkLoader loader(kPath, Schema({8, 4}), LoadOptions());
+  ColumnBatch good;
+  good.nrows = 2;
+  good.columns = {{1, 2}, {3, 4}};
+  ColumnBatch ragged;
+  ragged.nrows = 2;
+  ragged.columns = {{5, 6}, {7}};
+  CHECK_THROWS(loader.add({good, ragged}), std::invalid_argument);
+  loader.add({good});
+  CHECK(loader.finish().rows == 2);
+  ::unlink(kPath);
+}
+
+// A 4-byte column value outside int32_t would be stored as-is on a
+// compressed leaf but truncated on a plain one, so add() rejects it.
+void test_add_rejects_int32_overflow() {
+  BulkLoader loader(kPath, Schema({8, 4}), LoadOptions());
+  ColumnBatch batch;
+  batch.nrows = 1;
+  batch.columns = {{INT64_MAX}, {int64_t{INT32_MAX} + 1}};
+  CHECK_THROWS(loader.add({batch}), std::invalid_argument);
+  batch.columns[1] = {int64_t{INT32_MIN} - 1};
+  CHECK_THROWS(loader.add({batch}), std::invalid_argument);
+  batch.columns[1] = {INT32_MIN};
+  loader.add({batch});
+  CHECK(loader.finish().rows == 1);
+  ::unlink(kPath);
+}
+
+// Patching a sibling link rewrites part of a page that was already
+// counted; bytes_written must still match the file.
+void test_bytes_written_matches_file() {
+  BulkLoader loader(kPath, Schema({8}), LoadOptions());
+  ColumnBatch batch;
+  batch.nrows = 100000;
+  batch.columns.resize(1);
+  uint64_t x = 1;
+  for (size_t i = 0; i < batch.nrows; i++) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    batch.columns[0].push_back(static_cast<int64_t>(x));
+  }
+  loader.add({batch});
+  LoadStats stats = loader.finish();
+  struct stat st;
+  CHECK(::stat(kPath, &st) == 0);
+  CHECK(stats.pages_written > 32);
+  CHECK(stats.bytes_written == static_cast<uint64_t>(st.st_size));
+  CHECK(stats.bytes_written == stats.pages_written * kBlockSize);
+  ::unlink(kPath);
+}
+
+// Counts the compressed and plain leaves of attno's tree.
+void count_leaves(Relation& rel, int attno, int* compressed, int* plain) {
+  Page page;
+  rel.store().read(rel.column_root(attno), &page);
+  while (page.header()->level > 0) {
+    InternalItem first;
+    std::memcpy(&first, page.items(), sizeof(first));
+    rel.store().read(first.child, &page);
+  }
+  *compressed = *plain = 0;
+  for (;;) {
+    if (page.header()->flags & kLeafCompressed)
+      (*compressed)++;
+    else
+      (*plain)++;
+    if (page.header()->next == kInvalidBlock)
+      break;
+    rel.store().read(page.header()->next, &page);
+  }
+}
+
+// Scans every column of rel and compares it with cols, row by row.
+void check_contents(Relation& rel,
+                    const std::vector<std::vector<int64_t>>& cols) {
+  const Schema& schema = rel.schema();
+  TableScan scan(rel, {0, 1}, Snapshot{3});
+  ScanBatch batch;
+  size_t row = 0;
+  while (scan.next(batch)) {
+    for (size_t i = 0; i < batch.nrows; i++, row++) {
+      CHECK(row < cols[0].size());
+      CHECK(batch.tids[i] == kMinTid + row);
+      for (int c = 0; c < schema.natts(); c++) {
+        const unsigned char* p =
+            batch.columns[c].data() + i * schema.attlen(c);
+        int64_t v;
+        if (schema.attlen(c) == sizeof(int64_t)) {
+          std::memcpy(&v, p, sizeof(v));
+        } else {
+          int32_t v32;
+          std::memcpy(&v32, p, sizeof(v32));
+          v = v32;
+        }
+        CHECK(v == cols[c][row]);
+      }
+    }
+  }
+  CHECK(row == cols[0].size());
+}
+
+// Loads data that produces both compressed and plain leaves in an 8-byte
+// and a 4-byte column, inserts a row afterwards, and reads every value back.
+void test_read_back() {
+  const size_t nrows = 60000;
+  const size_t half = nrows / 2;
+  std::vector<std::vector<int64_t>> cols(2);
+  uint64_t x = 7;
+  for (size_t i = 0; i < nrows; i++) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    // Each half of each column is either regular or random.
+    cols[0].push_back(i < half ? static_cast<int64_t>(i) * 3
+                               : static_cast<int64_t>(x));
+    cols[1].push_back(i < half ? static_cast<int32_t>(x >> 32)
+                               : static_cast<int64_t>(i % 100) - 50);
+  }
+
+  {
+    LoadOptions opts;
+    opts.workers = 2;
+    BulkLoader loader(kPath, Schema({8, 4}), opts);
+    // Uneven batches, so leaves span batch boundaries.
+    for (size_t start = 0; start < nrows; start += 7001) {
+      ColumnBatch batch;
+      batch.nrows = std::min<size_t>(7001, nrows - start);
+      for (const std::vector<int64_t>& col : cols)
+        batch.columns.emplace_back(col.begin() + start,
+                                   col.begin() + start + batch.nrows);
+      loader.add({batch});
+    }
+    CHECK(loader.finish().rows == nrows);
+  }
+
+  std::unique_ptr<Relation> rel = Relation::open(kPath);
+  for (int c = 0; c < 2; c++) {
+    int compressed, plain;
+    count_leaves(*rel, c, &compressed, &plain);
+    CHECK(compressed > 0);
+    CHECK(plain > 0);
+  }
+  check_contents(*rel, cols);
+
+  unsigned char row[12];
+  const int64_t a = INT64_MIN;
+  const int32_t b = INT32_MAX;
+  std::memcpy(row, &a, sizeof(a));
+  std::memcpy(row + sizeof(a), &b, sizeof(b));
+  CHECK(rel->insert(row, 2) == kMinTid + nrows);
+  cols[0].push_back(a);
+  cols[1].push_back(b);
+  check_contents(*rel, cols);
+
+  rel->flush();
+  rel.reset();
+  rel = Relation::open(kPath);
+  check_contents(*rel, cols);
+  ::unlink(kPath);
+}
+
+}  // namespace
+
+int main() {
+  test_csv_limits();
+  test_csv_out_of_range();
+  test_add_rejects_ragged_batch();
+  test_add_rejects_int32_overflow();
+  test_bytes_written_matches_file();
+  test_read_back();
+  return 0;
+}
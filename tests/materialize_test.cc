@@ -0,0 +1,76 @@
+/*
+ * materialize_test.cc
+ *	  Tests for column-at-a-time row construction.
+ */
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "exec/arena.h"
+#include "exec/materialize.h"
+
+#include "check.h"
+
+using namespace zs;
+
+namespace {
+
+void test_builds_selected_rows() {
+  Materializer mat(Schema({8, 4}));
+  const int64_t a[] = {10, 11, 12};
+  const int32_t b[] = {20, 21, 22};
+  std::vector<ColumnVector> cols = {
+      {reinterpret_cast<const unsigned char*>(a), 8},
+      {reinterpret_cast<const unsigned char*>(b), 4}};
+  const uint32_t sel[] = {0, 2};
+  Arena arena;
+  TupleBatch batch = mat.materialize(cols, sel, 2, arena);
+  CHECK(batch.ntuples == 2);
+  CHECK(batch.row_width == 12);
+  int64_t x;
+  int32_t y;
+  std::memcpy(&x, batch.tuples[1], sizeof(x));
+  std::memcpy(&y, batch.tuples[1] + 8, sizeof(y));
+  CHECK(x == 12);
+  CHECK(y == 22);
+}
+
+// Column vectors whose widths disagree with the schema would be read past
+// their end; they must be rejected.
+void test_rejects_mismatched_columns() {
+  Materializer mat(Schema({8, 4}));
+  const int64_t a[] = {10, 11};
+  std::vector<ColumnVector> cols = {
+      {reinterpret_cast<const unsigned char*>(a), 8},
+      {reinterpret_cast<const unsigned char*>(a), 8}};
+  const uint32_t sel[] = {0, 1};
+  Arena arena;
+  CHECK_THROWS(mat.materialize(cols, sel, 2, arena), std::invalid_argument);
+  CHECK_THROWS(mat.materialize_all(cols, 2, arena), std::invalid_argument);
+  cols.pop_back();
+  CHECK_THROWS(mat.materialize_all(cols, 2, arena), std::invalid_argument);
+}
+
+// A scan batch with more columns than the projection's schema would index
+// past the schema; one with fewer would describe columns it does not have.
+void test_column_vectors_checks_count() {
+  ScanBatch batch;
+  batch.nrows = 1;
+  batch.columns.resize(2, std::vector<unsigned char>(8));
+  std::vector<ColumnVector> cols = column_vectors(batch, Schema({8, 4}));
+  CHECK(cols.size() == 2);
+  CHECK(cols[1].attlen == 4);
+  CHECK_THROWS(column_vectors(batch, Schema({8})), std::invalid_argument);
+  CHECK_THROWS(column_vectors(batch, Schema({8, 4, 4})),
+               std::invalid_argument);
+}
+
+}  // namespace
+
+int main() {
+  test_builds_selected_rows();
+  test_rejects_mismatched_columns();
+  test_column_vectors_checks_count();
+  return 0;
+}
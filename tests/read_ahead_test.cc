@@ -0,0 +1,147 @@
+/*
+ * read_ahead_test.cc
+ *	  Tests for queue-depth driven read-ahead.
+ */
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "aio/read_ahead.h"
+#include "storage/page_file.h"
+
+#include "check.h"
+
+using namespace zs;
+
+namespace {
+
+std::string write_file(BlockNumber npages) {
+  std::string path = "read_ahead_test.data";
+  PageFile file = PageFile::create(path);
+  Page page;
+  std::memset(page.data, 0, kBlockSize);
+  for (BlockNumber blkno = 0; blkno < npages; blkno++) {
+    std::memcpy(page.data, &blkno, sizeof(blkno));
+    file.write(blkno, &page);
+  }
+  file.sync();
+  return path;
+}
+
+void drain(ReadAhead& ra) {
+  ReadBatch batch;
+  while (ra.next(&batch))
+    ra.release(batch);
+}
+
+// Every page past the end of the file fails at once, so one wait returns
+// several failed completions.  next() must throw, and the reader must still
+// be destroyed rather than wait forever for reads it lost count of.
+void test_read_past_end(AioBackend backend) {
+  const BlockNumber kFilePages = 4;
+  std::string path = write_file(kFilePages);
+  std::vector<uint64_t> offsets;
+  for (BlockNumber b = 0; b < 64; b++)
+    offsets.push_back(static_cast<uint64_t>(b) * kBlockSize);
+
+  ReadAheadOptions opts;
+  opts.queue_depth = 16;
+  opts.max_pages_per_read = 1;
+  opts.backend = backend;
+  {
+    ReadAhead ra(path, offsets, opts);
+    CHECK_THROWS(drain(ra), std::runtime_error);
+  }
+  ::unlink(path.c_str());
+}
+
+// Adjacent pages are merged into reads of at most max_pages_per_read pages,
+// a gap starts a new read, and every page is delivered exactly once.
+void test_merges_runs(AioBackend backend) {
+  std::string path = write_file(64);
+  std::vector<uint64_t> offsets;
+  for (BlockNumber b = 0; b < 20; b++)
+    offsets.push_back(static_cast<uint64_t>(b) * kBlockSize);
+  for (BlockNumber b : {30, 31, 32, 40, 42})
+    offsets.push_back(static_cast<uint64_t>(b) * kBlockSize);
+
+  ReadAheadOptions opts;
+  opts.queue_depth = 3;
+  opts.max_pages_per_read = 8;
+  opts.backend = backend;
+  // npages of every read, indexed by its first page.
+  std::vector<uint32_t> expected(offsets.size(), 0);
+  expected[0] = 8;
+  expected[8] = 8;
+  expected[16] = 4;
+  expected[20] = 3;
+  expected[23] = 1;
+  expected[24] = 1;
+
+  std::vector<uint32_t> got(offsets.size(), 0);
+  std::vector<int> delivered(offsets.size(), 0);
+  {
+    ReadAhead ra(path, offsets, opts);
+    ReadBatch batch;
+    while (ra.next(&batch)) {
+      CHECK(batch.first < offsets.size());
+      CHECK(got[batch.first] == 0);
+      got[batch.first] = batch.npages;
+      for (uint32_t i = 0; i < batch.npages; i++) {
+        size_t idx = batch.first + i;
+        CHECK(idx < offsets.size());
+        delivered[idx]++;
+        BlockNumber blkno;
+        std::memcpy(&blkno, batch.data + i * kBlockSize, sizeof(blkno));
+        CHECK(blkno == offsets[idx] / kBlockSize);
+      }
+      ra.release(batch);
+    }
+  }
+  CHECK(got == expected);
+  for (int n : delivered)
+    CHECK(n == 1);
+  ::unlink(path.c_str());
+}
+
+// Lowest free descriptor number; it rises if a descriptor leaks.
+int lowest_free_fd() {
+  int fd = ::open("/dev/null", O_RDONLY);
+  CHECK(fd >= 0);
+  ::close(fd);
+  return fd;
+}
+
+// A constructor that fails after opening the file must close it again.
+void test_failed_constructor_closes_file(AioBackend backend) {
+  std::string path = write_file(1);
+  ReadAheadOptions opts;
+  // Slot buffers larger than the address space cannot be allocated.
+  opts.page_size = size_t{1} << 20;
+  opts.max_pages_per_read = 1u << 30;
+  opts.backend = backend;
+  int before = lowest_free_fd();
+  CHECK_THROWS(ReadAhead(path, {0}, opts), std::bad_alloc);
+  CHECK(lowest_free_fd() == before);
+  ::unlink(path.c_str());
+}
+
+}  // namespace
+
+int main() {
+  std::vector<AioBackend> backends = {AioBackend::kThreadPool};
+  if (ReadAhead::uring_available())
+    backends.push_back(AioBackend::kIoUring);
+  for (AioBackend backend : backends) {
+    test_read_past_end(backend);
+    test_merges_runs(backend);
+    test_failed_constructor_closes_file(backend);
+  }
+  return 0;
+}
@@ -0,0 +1,181 @@
+/*
+ * segment_test.cc
+ *	  Tests for zone-mapped column segments and their pruning scan.
+ */
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <unistd.h>
+
+#include "segment/segment_reader.h"
+#include "segment/segment_scan.h"
+#include "segment/segment_writer.h"
+
+#include "check.h"
+
+using namespace zs;
+
+namespace {
+
+const char* const kPath = "segment_test.seg";
+constexpr int64_t kMin = std::numeric_limits<int64_t>::min();
+constexpr int64_t kMax = std::numeric_limits<int64_t>::max();
+constexpr int64_t kNull = 0x4e554c4c;  // marks a NULL in the tables below
+
+// Four rows per page, two columns:
+//   group 0: a = 10 20 30 40        b all NULL
+//   group 1: a = MIN 0 5 MAX        b = 1 2 3 4
+//   group 2: a = 100 NULL 300 NULL  b = 5 6 7 8
+//   group 3: a = 50 60              b = 9 NULL
+const int64_t kRows[][2] = {
+    {10, kNull}, {20, kNull}, {30, kNull},  {40, kNull},
+    {kMin, 1},   {0, 2},      {5, 3},       {kMax, 4},
+    {100, 5},    {kNull, 6},  {300, 7},     {kNull, 8},
+    {50, 9},     {60, kNull},
+};
+
+void write_segment() {
+  SegmentWriter writer(kPath, 2, 4);
+  for (const auto& row : kRows) {
+    uint8_t isnull[2] = {row[0] == kNull, row[1] == kNull};
+    writer.append(row, isnull);
+  }
+  writer.finish();
+}
+
+struct ScanResult {
+  std::vector<uint64_t> row_ids;
+  SegmentScanStats stats;
+};
+
+ScanResult scan(SegmentReader& reader, std::vector<int> projection,
+                std::vector<Predicate> preds, bool use_zone_maps = true) {
+  SegmentScan s(reader, std::move(projection), std::move(preds),
+                use_zone_maps);
+  SegmentBatch batch;
+  ScanResult r;
+  while (s.next(batch))
+    r.row_ids.insert(r.row_ids.end(), batch.row_ids.begin(),
+                     batch.row_ids.end());
+  r.stats = s.stats();
+  CHECK(r.stats.pages_skipped + r.stats.pages_skipped_late +
+            r.stats.pages_read ==
+        r.stats.pages_total);
+  return r;
+}
+
+void check_zone(const ZoneEntry& z, int64_t min, int64_t max,
+                uint32_t nvalues, uint32_t null_count) {
+  CHECK(z.min == min);
+  CHECK(z.max == max);
+  CHECK(z.nvalues == nvalues);
+  CHECK(z.null_count == null_count);
+}
+
+// min, max and null_count written by the writer come back from the reader,
+// and min/max ignore NULLs.
+void test_zone_round_trip() {
+  SegmentReader reader(kPath);
+  CHECK(reader.natts() == 2);
+  CHECK(reader.nrows() == 14);
+  CHECK(reader.ngroups() == 4);
+  check_zone(reader.zone(0, 0), 10, 40, 4, 0);
+  check_zone(reader.zone(0, 1), 0, 0, 4, 4);
+  check_zone(reader.zone(1, 0), kMin, kMax, 4, 0);
+  check_zone(reader.zone(1, 1), 1, 4, 4, 0);
+  check_zone(reader.zone(2, 0), 100, 300, 4, 2);
+  check_zone(reader.zone(2, 1), 5, 8, 4, 0);
+  check_zone(reader.zone(3, 0), 50, 60, 2, 0);
+  check_zone(reader.zone(3, 1), 9, 9, 2, 1);
+}
+
+// Predicates at the very ends of the int64 range.
+void test_prune_edges() {
+  SegmentReader reader(kPath);
+
+  for (CompareOp op : {CompareOp::kLt, CompareOp::kGt}) {
+    int64_t value = op == CompareOp::kLt ? kMin : kMax;
+    ScanResult r = scan(reader, {0}, {{0, op, value}});
+    CHECK(r.row_ids.empty());
+    CHECK(r.stats.groups_skipped == 4);
+    CHECK(r.stats.pages_read == 0);
+  }
+
+  ScanResult r = scan(reader, {0}, {{0, CompareOp::kLe, kMin}});
+  CHECK(r.row_ids == std::vector<uint64_t>{4});
+  r = scan(reader, {0}, {{0, CompareOp::kGe, kMax}});
+  CHECK(r.row_ids == std::vector<uint64_t>{7});
+  CHECK(r.stats.groups_skipped == 3);
+}
+
+// Equality on a page's min or max must not prune that page.
+void test_prune_equality_on_bounds() {
+  SegmentReader reader(kPath);
+  struct {
+    int64_t value;
+    uint64_t row_id;
+    uint64_t groups_skipped;
+  } cases[] = {{10, 0, 2}, {40, 3, 2}, {100, 8, 2}, {300, 10, 2},
+               {50, 12, 2}, {60, 13, 2}, {kMin, 4, 3}, {kMax, 7, 3}};
+  for (const auto& c : cases) {
+    ScanResult r = scan(reader, {0}, {{0, CompareOp::kEq, c.value}});
+    CHECK(r.row_ids == std::vector<uint64_t>{c.row_id});
+    CHECK(r.stats.groups_skipped == c.groups_skipped);
+  }
+}
+
+// An all-NULL page satisfies no predicate, so its group is skipped.
+void test_all_null_page() {
+  SegmentReader reader(kPath);
+  ScanResult r = scan(reader, {1}, {{1, CompareOp::kGe, kMin}});
+  CHECK((r.row_ids == std::vector<uint64_t>{4, 5, 6, 7, 8, 9, 10, 11, 12}));
+  CHECK(r.stats.groups_skipped == 1);
+  CHECK(r.stats.pages_skipped == 1);
+}
+
+// A page inside the predicate's range is only skipped for filtering when
+// null_count says it has no NULLs.
+void test_skip_on_null_count() {
+  SegmentReader reader(kPath);
+  ScanResult r = scan(reader, {1}, {{0, CompareOp::kBetween, kMin, kMax}});
+  CHECK(r.row_ids.size() == 12);
+  CHECK(r.stats.groups_skipped == 0);
+  // b is read for every group; a only for group 2, which has NULLs.
+  CHECK(r.stats.pages_read == 5);
+  CHECK(r.stats.pages_skipped == 3);
+  CHECK(r.stats.pages_skipped_late == 0);
+}
+
+// Without zone maps nothing counts as skipped by them; projected pages of
+// groups where no row qualified are counted separately.
+void test_stats_without_zone_maps() {
+  SegmentReader reader(kPath);
+  ScanResult off = scan(reader, {1}, {{0, CompareOp::kEq, 10}}, false);
+  CHECK(off.row_ids == std::vector<uint64_t>{0});
+  CHECK(off.stats.groups_skipped == 0);
+  CHECK(off.stats.pages_skipped == 0);
+  CHECK(off.stats.pages_skipped_late == 3);
+  CHECK(off.stats.pages_read == 5);
+
+  ScanResult on = scan(reader, {1}, {{0, CompareOp::kEq, 10}});
+  CHECK(on.row_ids == off.row_ids);
+  CHECK(on.stats.groups_skipped == 2);
+  CHECK(on.stats.pages_skipped == 4);
+  CHECK(on.stats.pages_skipped_late == 1);
+  CHECK(on.stats.pages_read == 3);
+}
+
+}  // namespace
+
+int main() {
+  write_segment();
+  test_zone_round_trip();
+  test_prune_edges();
+  test_prune_equality_on_bounds();
+  test_all_null_page();
+  test_skip_on_null_count();
+  test_stats_without_zone_maps();
+  ::unlink(kPath);
+  return 0;
+}
@@ -0,0 +1,198 @@
+/*
+ * stats_test.cc
+ *	  Tests for the instrumentation counters, histograms and C API.
+ */
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "stats/stats.h"
+#include "stats/zs_stats.h"
+
+#include "check.h"
+
+using namespace zs;
+
+namespace {
+
+constexpr uint64_t kU64Max = std::numeric_limits<uint64_t>::max();
+
+// Buckets tile the whole 64-bit range without gaps, and every value lands
+// in the bucket whose bounds contain it.
+void test_hist_bucket_boundaries() {
+  for (uint64_t v = 0; v < kHistSubBuckets; v++) {
+    CHECK(hist_bucket(v) == v);
+    CHECK(hist_bucket_low(v) == v);
+    CHECK(hist_bucket_high(v) == v);
+  }
+  // The first power of two past the linear range still has unit buckets;
+  // the one after that has buckets two wide.
+  CHECK(hist_bucket(32) == 32);
+  CHECK(hist_bucket(63) == 63);
+  CHECK(hist_bucket(64) == 64);
+  CHECK(hist_bucket(65) == 64);
+  CHECK(hist_bucket(66) == 65);
+  CHECK(hist_bucket_high(64) == 65);
+  CHECK(hist_bucket(kU64Max) == kHistBuckets - 1);
+
+  CHECK(hist_bucket_low(0) == 0);
+  CHECK(hist_bucket_high(kHistBuckets - 1) == kU64Max);
+  for (size_t b = 0; b < kHistBuckets; b++) {
+    uint64_t low = hist_bucket_low(b);
+    uint64_t high = hist_bucket_high(b);
+    CHECK(low <= high);
+    CHECK(hist_bucket(low) == b);
+    CHECK(hist_bucket(high) == b);
+    if (b + 1 < kHistBuckets)
+      CHECK(hist_bucket_low(b + 1) == high + 1);
+    // Within about 3% of any value in the bucket.
+    if (b >= kHistSubBuckets)
+      CHECK(high - low < low / kHistSubBuckets);
+  }
+}
+
+HistogramSnapshot histogram_of(const std::vector<uint64_t>& values) {
+  HistogramSnapshot h;
+  for (uint64_t v : values) {
+    h.samples++;
+    h.sum += v;
+    h.buckets[hist_bucket(v)]++;
+  }
+  return h;
+}
+
+void test_percentile() {
+  CHECK(HistogramSnapshot().percentile(50) == 0);
+  CHECK(HistogramSnapshot().min() == 0);
+  CHECK(HistogramSnapshot().max() == 0);
+
+  // 1..20, each in its own exact bucket.
+  std::vector<uint64_t> uniform;
+  for (uint64_t v = 1; v <= 20; v++)
+    uniform.push_back(v);
+  HistogramSnapshot h = histogram_of(uniform);
+  CHECK(h.percentile(0) == 1);
+  CHECK(h.percentile(5) == 1);
+  CHECK(h.percentile(50) == 10);
+  CHECK(h.percentile(51) == 11);
+  CHECK(h.percentile(95) == 19);
+  CHECK(h.percentile(99) == 20);
+  CHECK(h.percentile(100) == 20);
+  CHECK(h.min() == 1);
+  CHECK(h.max() == 20);
+  CHECK(h.mean() == 10.5);
+
+  // 90 fast samples and a slow tail of 10.
+  std::vector<uint64_t> tail(90, 5);
+  tail.insert(tail.end(), 10, 1000);
+  h = histogram_of(tail);
+  CHECK(h.percentile(50) == 5);
+  CHECK(h.percentile(90) == 5);
+  CHECK(h.percentile(91) == hist_bucket_high(hist_bucket(1000)));
+  CHECK(h.percentile(100) == hist_bucket_high(hist_bucket(1000)));
+  CHECK(h.percentile(91) >= 1000);
+  CHECK(h.percentile(91) < 1000 + 1000 / kHistSubBuckets);
+}
+
+#ifndef ZS_NO_STATS
+
+// A reset hides everything recorded before it, including by threads that
+// have since exited, while recording afterwards still counts.
+void test_reset() {
+  stats_set_enabled(true);
+  stat_add(StatCounter::kCacheHits, 3);
+  stat_record(StatHistogram::kPageRead, 100);
+  std::thread([] { stat_add(StatCounter::kCacheHits, 4); }).join();
+  StatsSnapshot snap = stats_snapshot();
+  CHECK(snap.counter(StatCounter::kCacheHits) >= 7);
+
+  stats_reset();
+  snap = stats_snapshot();
+  for (uint64_t c : snap.counters)
+    CHECK(c == 0);
+  for (const HistogramSnapshot& h : snap.histograms) {
+    CHECK(h.samples == 0);
+    CHECK(h.sum == 0);
+    for (uint64_t n : h.buckets)
+      CHECK(n == 0);
+  }
+
+  stat_add(StatCounter::kCacheHits, 2);
+  stat_record(StatHistogram::kPageRead, 7);
+  stat_record(StatHistogram::kPageRead, 9);
+  snap = stats_snapshot();
+  CHECK(snap.counter(StatCounter::kCacheHits) == 2);
+  const HistogramSnapshot& h = snap.histogram(StatHistogram::kPageRead);
+  CHECK(h.samples == 2);
+  CHECK(h.sum == 16);
+  CHECK(h.percentile(50) == 7);
+  CHECK(h.percentile(100) == 9);
+  stats_reset();
+}
+
+// The C API's JSON follows snprintf conventions, including when the
+// caller's buffer is too small.
+void test_c_api_json() {
+  stats_set_enabled(true);
+  stats_reset();
+  stat_add(StatCounter::kPageReads, 3);
+  stat_record(StatHistogram::kDecodeBatch, 20);
+  zs_stats_snapshot* snap = zs_stats_snapshot_take();
+  CHECK(snap != nullptr);
+
+  size_t len = zs_stats_snapshot_json(snap, nullptr, 0);
+  CHECK(len > 0);
+  std::vector<char> full(len + 1, 'x');
+  CHECK(zs_stats_snapshot_json(snap, full.data(), full.size()) == len);
+  CHECK(full[len] == '\0');
+  std::string json(full.data());
+  CHECK(json.size() == len);
+  CHECK(json.front() == '{');
+  CHECK(json.back() == '}');
+  CHECK(json.find("\"enabled\":true") != std::string::npos);
+  CHECK(json.find("\"page_reads\":3,") != std::string::npos);
+  CHECK(json.find("\"decode_batch_ns\":{\"samples\":1,") !=
+        std::string::npos);
+  CHECK(json.find("[20,20,1]") != std::string::npos);
+
+  // Too small: a NUL-terminated prefix, and still the full length.
+  std::vector<char> small(16, 'x');
+  CHECK(zs_stats_snapshot_json(snap, small.data(), small.size()) == len);
+  CHECK(small[15] == '\0');
+  CHECK(json.compare(0, 15, small.data()) == 0);
+
+  // Exactly one byte short of the NUL.
+  std::vector<char> short_by_one(len, 'x');
+  CHECK(zs_stats_snapshot_json(snap, short_by_one.data(), len) == len);
+  CHECK(short_by_one[len - 1] == '\0');
+  CHECK(json.compare(0, len - 1, short_by_one.data()) == 0);
+
+  // Room for the NUL only, and no room at all.
+  char one = 'x';
+  CHECK(zs_stats_snapshot_json(snap, &one, 1) == len);
+  CHECK(one == '\0');
+  char none = 'x';
+  CHECK(zs_stats_snapshot_json(snap, &none, 0) == len);
+  CHECK(none == 'x');
+
+  CHECK(zs_stats_snapshot_json(nullptr, full.data(), full.size()) == 0);
+  zs_stats_snapshot_free(snap);
+  stats_reset();
+}
+
+#endif
+
+}  // namespace
+
+int main() {
+  test_hist_bucket_boundaries();
+  test_percentile();
+#ifndef ZS_NO_STATS
+  test_reset();
+  test_c_api_json();
+#endif
+  return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * zs_load.cc
+ *	  Command-line front end of the bulk loader.
+ *
+ * usage: zs_load --schema=TYPES [--format=csv|binary] [--header]
+ *                [--delimiter=C] [--workers=N] [--xid=N] INPUT OUTPUT
+ *
+ * TYPES is a comma-separated list of int32/int64 (or i32/i64), one per
+ * column.  INPUT may be "-" for standard input.  OUTPUT is created or
+ * truncated.
+ */
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "loader/bulk_loader.h"
+#include "loader/input.h"
+
+using namespace zs;
+
+namespace {
+
+[[noreturn]] void usage(const char* argv0) {
+  std::fprintf(stderr,
+               "usage: %s --schema=TYPES [--format=csv|binary] [--header]\n"
+               "          [--delimiter=C] [--workers=N] [--xid=N]\n"
+               "          INPUT OUTPUT\n"
+               "TYPES is a comma-separated list of int32 or int64.\n",
+               argv0);
+  std::exit(2);
+}
+
+bool parse_schema(const char* s, std::vector<uint16_t>* attlens) {
+  std::string spec(s);
+  size_t pos = 0;
+  while (pos <= spec.size()) {
+    size_t comma = spec.find(',', pos);
+    std::string type = spec.substr(pos, comma == std::string::npos
+                                            ? std::string::npos
+                                            : comma - pos);
+    if (type == "int32" || type == "i32")
+      attlens->push_back(4);
+    else if (type == "int64" || type == "i64")
+      attlens->push_back(8);
+    else
+      return false;
+    if (comma == std::string::npos)
+      break;
+    pos = comma + 1;
+  }
+  return !attlens->empty();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::vector<uint16_t> attlens;
+  bool binary = false;
+  InputOptions input;
+  LoadOptions load;
+  load.workers = static_cast<int>(std::thread::hardware_concurrency());
+  if (load.workers < 1)
+    load.workers = 1;
+  std::vector<const char*> paths;
+
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (std::strncmp(arg, "--schema=", 9) == 0) {
+      if (!parse_schema(arg + 9, &attlens)) {
+        std::fprintf(stderr, "%s: invalid schema \"%s\"\n", argv[0], arg + 9);
+        return 2;
+      }
+    } else if (std::strcmp(arg, "--format=csv") == 0)
+      binary = false;
+    else if (std::strcmp(arg, "--format=binary") == 0)
+      binary = true;
+    else if (std::strcmp(arg, "--header") == 0)
+      input.header = true;
+    else if (std::strncmp(arg, "--delimiter=", 12) == 0 &&
+             std::strlen(arg + 12) == 1)
+      input.delimiter = arg[12];
+    else if (std::strncmp(arg, "--workers=", 10) == 0)
+      load.workers = std::atoi(arg + 10);
+    else if (std::strncmp(arg, "--xid=", 6) == 0)
+      load.xid = static_cast<TransactionId>(std::strtoul(arg + 6, nullptr, 10));
+    else if (arg[0] == '-' && arg[1] != '\0')
+      usage(argv[0]);
+    else
+      paths.push_back(arg);
+  }
+  if (attlens.empty() || paths.size() != 2 || load.workers < 1)
+    usage(argv[0]);
+
+  std::FILE* in = std::strcmp(paths[0], "-") == 0 ? stdin
+                                                  : std::fopen(paths[0], "rb");
+  if (in == nullptr) {
+    std::fprintf(stderr, "%s: could not open \"%s\": %s\n", argv[0], paths[0],
+                 std::strerror(errno));
+    return 1;
+  }
+
+  try {
+    auto start = std::chrono::steady_clock::now();
+    BulkLoader loader(paths[1], Schema(attlens), load);
+    uint64_t input_bytes = binary ? load_binary(in, loader, input)
+                                  : load_csv(in, loader, input);
+    LoadStats stats = loader.finish();
+    double secs = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+
+    std::printf("rows:          %llu\n",
+                static_cast<unsigned long long>(stats.rows));
+    std::printf("input bytes:   %llu\n",
+                static_cast<unsigned long long>(input_bytes));
+    std::printf("bytes written: %llu (%llu pages)\n",
+                static_cast<unsigned long long>(stats.bytes_written),
+                static_cast<unsigned long long>(stats.pages_written));
+    std::printf("elapsed:       %.3f s\n", secs);
+    std::printf("rows/s:        %.0f\n", stats.rows / secs);
+    std::printf("write MB/s:    %.1f\n", stats.bytes_written / secs / 1e6);
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+    return 1;
+  }
+
+  if (in != stdin)
+    std::fclose(in);
+  return 0;
+}